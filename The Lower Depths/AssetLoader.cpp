@@ -0,0 +1,47 @@
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+void AssetLoader::Add(const std::string &asset_class, std::function<void()> job) {
+    auto it = std::find(classes_.begin(), classes_.end(), asset_class);
+    size_t idx = it - classes_.begin();
+    if (it == classes_.end()) {
+        classes_.push_back(asset_class);
+    }
+    jobs_.push_back({idx, std::move(job)});
+}
+
+void AssetLoader::Run(ThreadPool &pool) {
+    using clock = std::chrono::steady_clock;
+    auto begin = clock::now();
+    auto since_begin = [begin] {
+        return std::chrono::duration<double>(clock::now() - begin).count();
+    };
+    pool.ParallelFor(jobs_.size(), [&](size_t i) {
+        jobs_[i].start = since_begin();
+        jobs_[i].work();
+        jobs_[i].end = since_begin();
+    });
+    double total = since_begin();
+
+    for (size_t c = 0; c < classes_.size(); ++c) {
+        int count = 0;
+        double first = total, last = 0, busy = 0;
+        for (const auto &job : jobs_) {
+            if (job.asset_class == c) {
+                ++count;
+                first = std::min(first, job.start);
+                last = std::max(last, job.end);
+                busy += job.end - job.start;
+            }
+        }
+        std::cout << "Loaded " << classes_[c] << ": " << count << " in " << (last - first) * 1000
+                  << " ms (" << busy * 1000 << " ms decoding)" << std::endl;
+    }
+    std::cout << "Loaded " << jobs_.size() << " assets in " << total * 1000 << " ms on "
+              << pool.Size() << " threads" << std::endl;
+    jobs_.clear();
+    classes_.clear();
+}
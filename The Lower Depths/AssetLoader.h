@@ -0,0 +1,28 @@
+#ifndef MAIN_ASSET_LOADER_H
+#define MAIN_ASSET_LOADER_H
+
+#include "ThreadPool.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Collects asset decode jobs grouped by asset class ("tiles", "player_sprite", ...)
+// and runs them all at once on a thread pool.
+class AssetLoader {
+public:
+    void Add(const std::string &asset_class, std::function<void()> job);
+    // runs every queued job and blocks until all are done, then prints per-class timings
+    void Run(ThreadPool &pool);
+
+private:
+    struct Job {
+        size_t asset_class;
+        std::function<void()> work;
+        double start = 0, end = 0;  // seconds since Run began
+    };
+    std::vector<std::string> classes_;
+    std::vector<Job> jobs_;
+};
+
+#endif  // MAIN_ASSET_LOADER_H
@@ -0,0 +1,295 @@
+#include "Blend.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BLEND_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BLEND_TARGET(isa)
+#else
+#define BLEND_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace {
+
+// v / 255 rounded to nearest, exact for v <= 255 * 255 + 127
+inline uint8_t Div255(unsigned v) {
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+inline uint8_t Lerp(uint8_t src, uint8_t dst, unsigned a) {
+    return Div255(src * a + dst * (255 - a));
+}
+
+void CopyRowMaskedScalar(Pixel *dst, const Pixel *src, int n) {
+    for (int i = 0; i < n; ++i) {
+        if (src[i].a) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+void BlendRowAlphaScalar(Pixel *dst, const Pixel *src, int n) {
+    for (int i = 0; i < n; ++i) {
+        unsigned a = src[i].a;
+        dst[i] = {Lerp(src[i].r, dst[i].r, a), Lerp(src[i].g, dst[i].g, a),
+                  Lerp(src[i].b, dst[i].b, a), Lerp(src[i].a, dst[i].a, a)};
+    }
+}
+
+void BlendRowEffectScalar(Pixel *dst, const Pixel *src, int n) {
+    auto screen = [](uint8_t s, uint8_t d) {
+        return static_cast<uint8_t>(s + Div255(d * (255 - s)));
+    };
+    for (int i = 0; i < n; ++i) {
+        dst[i] = {screen(src[i].r, dst[i].r), screen(src[i].g, dst[i].g),
+                  screen(src[i].b, dst[i].b), screen(src[i].a, dst[i].a)};
+    }
+}
+
+#ifdef BLEND_X86
+
+// The SIMD kernels widen channels to 16 bits: every product sum is <= 255 * 255,
+// so Div255 fits in unsigned 16-bit lanes and matches the scalar rounding exactly.
+// Pixels are RGBA bytes, i.e. alpha is the top byte of each 32-bit lane.
+
+BLEND_TARGET("sse2") inline __m128i Div255Sse2(__m128i v) {
+    v = _mm_add_epi16(v, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+// s * a + d * (255 - a) / 255 for two widened pixels, a taken from s
+BLEND_TARGET("sse2") inline __m128i LerpSse2(__m128i s, __m128i d) {
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+    __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    return Div255Sse2(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, ia)));
+}
+
+// s + d * (255 - s) / 255 for two widened pixels
+BLEND_TARGET("sse2") inline __m128i ScreenSse2(__m128i s, __m128i d) {
+    __m128i is = _mm_sub_epi16(_mm_set1_epi16(255), s);
+    return _mm_add_epi16(s, Div255Sse2(_mm_mullo_epi16(d, is)));
+}
+
+BLEND_TARGET("sse2") void CopyRowMaskedSse2(Pixel *dst, const Pixel *src, int n) {
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(s, alpha), _mm_setzero_si128());
+        __m128i out = _mm_or_si128(_mm_and_si128(clear, d), _mm_andnot_si128(clear, s));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), out);
+    }
+    CopyRowMaskedScalar(dst + i, src + i, n - i);
+}
+
+BLEND_TARGET("sse2") void BlendRowAlphaSse2(Pixel *dst, const Pixel *src, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i lo = LerpSse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        __m128i hi = LerpSse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    BlendRowAlphaScalar(dst + i, src + i, n - i);
+}
+
+BLEND_TARGET("sse2") void BlendRowEffectSse2(Pixel *dst, const Pixel *src, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i lo = ScreenSse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        __m128i hi = ScreenSse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    BlendRowEffectScalar(dst + i, src + i, n - i);
+}
+
+// AVX2 unpack/shuffle/pack all work within 128-bit lanes, so the widened
+// layout is the SSE2 one twice and packing restores the original pixel order
+
+BLEND_TARGET("avx2") inline __m256i Div255Avx2(__m256i v) {
+    v = _mm256_add_epi16(v, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), 8);
+}
+
+BLEND_TARGET("avx2") inline __m256i LerpAvx2(__m256i s, __m256i d) {
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xff), 0xff);
+    __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    return Div255Avx2(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, ia)));
+}
+
+BLEND_TARGET("avx2") inline __m256i ScreenAvx2(__m256i s, __m256i d) {
+    __m256i is = _mm256_sub_epi16(_mm256_set1_epi16(255), s);
+    return _mm256_add_epi16(s, Div255Avx2(_mm256_mullo_epi16(d, is)));
+}
+
+BLEND_TARGET("avx2") void CopyRowMaskedAvx2(Pixel *dst, const Pixel *src, int n) {
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i clear = _mm256_cmpeq_epi32(_mm256_and_si256(s, alpha), _mm256_setzero_si256());
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_blendv_epi8(s, d, clear));
+    }
+    CopyRowMaskedSse2(dst + i, src + i, n - i);
+}
+
+BLEND_TARGET("avx2") void BlendRowAlphaAvx2(Pixel *dst, const Pixel *src, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i lo = LerpAvx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+        __m256i hi = LerpAvx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    BlendRowAlphaSse2(dst + i, src + i, n - i);
+}
+
+BLEND_TARGET("avx2") void BlendRowEffectAvx2(Pixel *dst, const Pixel *src, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i lo = ScreenAvx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+        __m256i hi = ScreenAvx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    BlendRowEffectSse2(dst + i, src + i, n - i);
+}
+
+bool CpuHasSse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return info[3] & (1 << 26);
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28);
+    // the OS must save the YMM registers on context switches
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // BLEND_X86
+
+struct BlendKernels {
+    BlendIsa isa;
+    void (*copy_masked)(Pixel *, const Pixel *, int);
+    void (*alpha)(Pixel *, const Pixel *, int);
+    void (*effect)(Pixel *, const Pixel *, int);
+};
+
+constexpr BlendKernels SCALAR_KERNELS{BlendIsa::SCALAR, CopyRowMaskedScalar, BlendRowAlphaScalar,
+                                      BlendRowEffectScalar};
+#ifdef BLEND_X86
+constexpr BlendKernels SSE2_KERNELS{BlendIsa::SSE2, CopyRowMaskedSse2, BlendRowAlphaSse2,
+                                    BlendRowEffectSse2};
+constexpr BlendKernels AVX2_KERNELS{BlendIsa::AVX2, CopyRowMaskedAvx2, BlendRowAlphaAvx2,
+                                    BlendRowEffectAvx2};
+#endif
+
+const BlendKernels *KernelsFor(BlendIsa isa) {
+#ifdef BLEND_X86
+    if (isa == BlendIsa::AVX2 && CpuHasAvx2()) {
+        return &AVX2_KERNELS;
+    }
+    if (isa == BlendIsa::SSE2 && CpuHasSse2()) {
+        return &SSE2_KERNELS;
+    }
+#endif
+    return isa == BlendIsa::SCALAR ? &SCALAR_KERNELS : nullptr;
+}
+
+const BlendKernels *DetectKernels() {
+    for (BlendIsa isa : {BlendIsa::AVX2, BlendIsa::SSE2}) {
+        if (const BlendKernels *kernels = KernelsFor(isa)) {
+            return kernels;
+        }
+    }
+    return &SCALAR_KERNELS;
+}
+
+const BlendKernels *&Kernels() {
+    static const BlendKernels *kernels = DetectKernels();
+    return kernels;
+}
+
+}  // namespace
+
+void CopyRowMasked(Pixel *dst, const Pixel *src, int n) {
+    Kernels()->copy_masked(dst, src, n);
+}
+
+void BlendRowAlpha(Pixel *dst, const Pixel *src, int n) {
+    Kernels()->alpha(dst, src, n);
+}
+
+void BlendRowEffect(Pixel *dst, const Pixel *src, int n) {
+    Kernels()->effect(dst, src, n);
+}
+
+void BlendRowConstant(Pixel *dst, Pixel color, uint8_t alpha, int n) {
+    for (int i = 0; i < n; ++i) {
+        dst[i] = {Lerp(color.r, dst[i].r, alpha), Lerp(color.g, dst[i].g, alpha),
+                  Lerp(color.b, dst[i].b, alpha), Lerp(color.a, dst[i].a, alpha)};
+    }
+}
+
+const char *BlendIsaName(BlendIsa isa) {
+    switch (isa) {
+        case BlendIsa::SSE2:
+            return "sse2";
+        case BlendIsa::AVX2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+bool BlendIsaSupported(BlendIsa isa) {
+    return KernelsFor(isa) != nullptr;
+}
+
+BlendIsa ActiveBlendIsa() {
+    return Kernels()->isa;
+}
+
+bool SetBlendIsa(BlendIsa isa) {
+    const BlendKernels *kernels = KernelsFor(isa);
+    if (!kernels) {
+        return false;
+    }
+    Kernels() = kernels;
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef MAIN_BLEND_H
+#define MAIN_BLEND_H
+
+#include "Image.h"
+
+#include <cstdint>
+
+// The two ways GameRender composites an image over the framebuffer
+enum class BlendMode {
+    ALPHA,   // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+    EFFECT,  // glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_COLOR), full-screen light effects
+};
+
+// Row kernels over n RGBA8 pixels, results rounded like an 8-bit GL framebuffer
+// (x / 255 rounded to nearest). dst and src must not overlap.
+// Every instruction set gives bit-identical results.
+
+// dst = src where src.a != 0 (the CPU tile compositing of PutTileOver)
+void CopyRowMasked(Pixel *dst, const Pixel *src, int n);
+// dst = src * src.a + dst * (1 - src.a), every channel
+void BlendRowAlpha(Pixel *dst, const Pixel *src, int n);
+// dst = src + dst * (1 - src), per channel
+void BlendRowEffect(Pixel *dst, const Pixel *src, int n);
+// dst = color * alpha + dst * (1 - alpha) with a constant alpha (the room fade overlay)
+void BlendRowConstant(Pixel *dst, Pixel color, uint8_t alpha, int n);
+
+// Kernels are picked once from the CPU features; SetBlendIsa overrides that
+// (for benchmarks and tests, not thread-safe against running kernels).
+enum class BlendIsa {SCALAR, SSE2, AVX2};
+const char *BlendIsaName(BlendIsa isa);
+bool BlendIsaSupported(BlendIsa isa);
+BlendIsa ActiveBlendIsa();
+bool SetBlendIsa(BlendIsa isa);
+
+#endif  // MAIN_BLEND_H
@@ -0,0 +1,137 @@
+#include "Bundle.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetBundle::~AssetBundle() {
+    Close();
+}
+
+bool AssetBundle::Open(const std::string &path) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    mapping_ = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping_) {
+        return false;
+    }
+    base_ = static_cast<char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        size_ = st.st_size;
+        void *addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        base_ = addr == MAP_FAILED ? nullptr : static_cast<char *>(addr);
+    }
+    close(fd);  // the mapping keeps the file alive
+#endif
+    if (!base_) {
+        std::cerr << "Failed to map " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    auto header = reinterpret_cast<const BundleHeader *>(base_);
+    if (size_ < sizeof(BundleHeader) || std::memcmp(header->magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0) {
+        std::cerr << "Not an asset bundle: " << path << std::endl;
+        Close();
+        return false;
+    }
+    if (header->version != BUNDLE_VERSION) {
+        std::cerr << "Asset bundle version " << header->version << " != " << BUNDLE_VERSION
+                  << ", rebuild it with the packer" << std::endl;
+        Close();
+        return false;
+    }
+    auto entries = reinterpret_cast<const BundleEntry *>(base_ + sizeof(BundleHeader));
+    if (sizeof(BundleHeader) + header->count * sizeof(BundleEntry) > size_) {
+        std::cerr << "Truncated asset bundle: " << path << std::endl;
+        Close();
+        return false;
+    }
+    for (uint32_t i = 0; i < header->count; ++i) {
+        const BundleEntry &entry = entries[i];
+        if (entry.offset + uint64_t(entry.width) * entry.height * sizeof(Pixel) > size_) {
+            std::cerr << "Truncated asset bundle: " << path << std::endl;
+            Close();
+            return false;
+        }
+        index_.emplace(std::string(entry.name, strnlen(entry.name, BUNDLE_NAME_LEN)), &entry);
+    }
+    return true;
+}
+
+void AssetBundle::Close() {
+    index_.clear();
+#ifdef _WIN32
+    if (base_) {
+        UnmapViewOfFile(base_);
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+#else
+    if (base_) {
+        munmap(base_, size_);
+    }
+#endif
+    base_ = nullptr;
+    size_ = 0;
+}
+
+Image AssetBundle::View(const std::string &name) const {
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+        std::cerr << "Asset bundle has no " << name << std::endl;
+        return Image();
+    }
+    const BundleEntry &entry = *it->second;
+    // the mapping is read-only: nothing in the game draws into asset images
+    return Image::View(reinterpret_cast<Pixel *>(base_ + entry.offset), entry.width, entry.height);
+}
+
+Image BuildTileAtlas(const std::string &tiles_dir) {
+    Image atlas(ATLAS_WIDTH, ATLAS_HEIGHT);
+    for (int n = 0; n < ATLAS_TILE_COUNT; ++n) {
+        LoadAtlasTile(atlas, n, tiles_dir);
+    }
+    return atlas;
+}
+
+void LoadAtlasTile(Image &atlas, int n, const std::string &tiles_dir) {
+    Image tile(tiles_dir + std::to_string(n) + ".png");
+    if (tile.width() != ATLAS_TILE_SIZE || tile.height() != ATLAS_TILE_SIZE) {
+        std::cerr << "Tile " << n << " is not " << ATLAS_TILE_SIZE << "x" << ATLAS_TILE_SIZE << std::endl;
+        return;
+    }
+    atlas.PutTile(n % ATLAS_COLUMNS * ATLAS_TILE_SIZE, n / ATLAS_COLUMNS * ATLAS_TILE_SIZE, tile);
+}
+
+Image AtlasTile(const Image &atlas, int n) {
+    return atlas.SubImage(n % ATLAS_COLUMNS * ATLAS_TILE_SIZE, n / ATLAS_COLUMNS * ATLAS_TILE_SIZE,
+                          ATLAS_TILE_SIZE, ATLAS_TILE_SIZE);
+}
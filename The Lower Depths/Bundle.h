@@ -0,0 +1,77 @@
+#ifndef MAIN_BUNDLE_H
+#define MAIN_BUNDLE_H
+
+#include "Image.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Pre-decoded RGBA asset bundle produced by the packer target.
+// Layout (native byte order):
+//   BundleHeader
+//   BundleEntry[count]    -- index, offsets are from the file start
+//   pixel data            -- width * height * 4 bytes per entry, BUNDLE_ALIGN aligned
+constexpr char BUNDLE_MAGIC[4] = {'L', 'D', 'A', 'B'};
+constexpr uint32_t BUNDLE_VERSION = 2;
+constexpr int BUNDLE_NAME_LEN = 48;
+constexpr uint64_t BUNDLE_ALIGN = 64;
+
+// tiles/N.png are not stored one by one but baked into a single "tiles/atlas" image:
+// tile N sits at column N % ATLAS_COLUMNS, row N / ATLAS_COLUMNS
+constexpr int ATLAS_TILE_SIZE = 16;
+constexpr int ATLAS_COLUMNS = 32;
+constexpr int ATLAS_TILE_COUNT = 864 + 1;
+constexpr int ATLAS_WIDTH = ATLAS_COLUMNS * ATLAS_TILE_SIZE;
+constexpr int ATLAS_HEIGHT = (ATLAS_TILE_COUNT + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS * ATLAS_TILE_SIZE;
+constexpr const char *ATLAS_NAME = "tiles/atlas";
+
+// decodes tiles_dir/N.png for N < ATLAS_TILE_COUNT into one contiguous atlas image
+Image BuildTileAtlas(const std::string &tiles_dir);
+// decodes tiles_dir/n.png into its slot of an ATLAS_WIDTH x ATLAS_HEIGHT atlas;
+// slots are disjoint, so different tiles can be loaded concurrently
+void LoadAtlasTile(Image &atlas, int n, const std::string &tiles_dir);
+// view of tile N inside the atlas
+Image AtlasTile(const Image &atlas, int n);
+
+struct BundleHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct BundleEntry {
+    char name[BUNDLE_NAME_LEN];  // "tiles/12", "sprites/player_up_0", ... (no extension)
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+};
+
+// Read-only memory mapping of the bundle. Images handed out are views into the
+// mapping: no heap, no copies, and the page cache is shared between processes.
+class AssetBundle {
+public:
+    AssetBundle() {}
+    ~AssetBundle();
+    AssetBundle(const AssetBundle &) = delete;
+    AssetBundle &operator =(const AssetBundle &) = delete;
+
+    bool Open(const std::string &path);
+    void Close();
+    bool IsOpen() const { return base_ != nullptr; }
+    size_t MappedSize() const { return size_; }
+
+    // view into the mapping, valid while the bundle stays open; empty image if missing
+    Image View(const std::string &name) const;
+
+private:
+    char *base_ = nullptr;
+    size_t size_ = 0;
+    std::unordered_map<std::string, const BundleEntry *> index_;
+#ifdef _WIN32
+    void *mapping_ = nullptr;
+#endif
+};
+
+#endif  // MAIN_BUNDLE_H
@@ -0,0 +1,93 @@
+#include "Collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+// floor(a / b) for b > 0, also for negative a
+static int FloorDiv(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+CellGrid BuildCellGrid(const std::array<char[MAP_WIDTH + 1], MAP_HEIGHT> &objects) {
+    CellGrid cells;
+    for (int i = 0; i < MAP_HEIGHT; ++i) {
+        for (int j = 0; j < MAP_WIDTH; ++j) {
+            cells[i * MAP_WIDTH + j] = CellMask(objects[i][j]);
+        }
+    }
+    return cells;
+}
+
+uint8_t CellAt(const CellGrid &cells, int col, int row) {
+    if (col < 0 || row < 0 || col >= MAP_WIDTH || row >= MAP_HEIGHT) {
+        return CELL_WALL;
+    }
+    return cells[row * MAP_WIDTH + col];
+}
+
+Point<int> BoxCell(Point<double> pos, const HitBox &box) {
+    return {static_cast<int>(std::floor((pos.x + (box.x0 + box.x1) / 2.0) / TILE_SIZE)),
+            static_cast<int>(std::floor((pos.y + (box.y0 + box.y1) / 2.0) / TILE_SIZE))};
+}
+
+uint8_t BoxBits(const CellGrid &cells, Point<double> pos, const HitBox &box) {
+    int x = static_cast<int>(std::floor(pos.x)), y = static_cast<int>(std::floor(pos.y));
+    uint8_t bits = 0;
+    for (int row = FloorDiv(y + box.y0, TILE_SIZE); row <= FloorDiv(y + box.y1 - 1, TILE_SIZE); ++row) {
+        for (int col = FloorDiv(x + box.x0, TILE_SIZE); col <= FloorDiv(x + box.x1 - 1, TILE_SIZE); ++col) {
+            bits |= CellAt(cells, col, row);
+        }
+    }
+    return bits;
+}
+
+Point<double> SweepBox(const CellGrid &cells, Point<double> pos, const HitBox &box,
+                       Direction dir, double dist, uint8_t blocking, uint8_t &touched) {
+    // "along" is the axis of motion, "across" the other one; positions are floored to
+    // whole pixels like everywhere else the game turns them into cells
+    bool horizontal = dir == Direction::LEFT || dir == Direction::RIGHT;
+    bool forward = dir == Direction::RIGHT || dir == Direction::DOWN;
+    double along = horizontal ? pos.x : pos.y;
+    int across = static_cast<int>(std::floor(horizontal ? pos.y : pos.x));
+    int lo = horizontal ? box.x0 : box.y0, hi = horizontal ? box.x1 : box.y1;
+    int b0 = FloorDiv(across + (horizontal ? box.y0 : box.x0), TILE_SIZE);
+    int b1 = FloorDiv(across + (horizontal ? box.y1 : box.x1) - 1, TILE_SIZE);
+    // bits of the cells the box covers in column (or row) a
+    auto line = [&](int a) {
+        uint8_t bits = 0;
+        for (int b = b0; b <= b1; ++b) {
+            bits |= horizontal ? CellAt(cells, a, b) : CellAt(cells, b, a);
+        }
+        return bits;
+    };
+    auto result = [&](double along) {
+        return horizontal ? Point<double>{along, pos.y} : Point<double>{pos.x, along};
+    };
+
+    int p = static_cast<int>(std::floor(along));
+    int first = FloorDiv(p + lo, TILE_SIZE), last = FloorDiv(p + hi - 1, TILE_SIZE);
+    touched = 0;
+    for (int a = first; a <= last; ++a) {
+        touched |= line(a) & ~blocking;
+    }
+    double target = forward ? along + dist : along - dist;
+    int t = static_cast<int>(std::floor(target));
+    if (forward) {
+        for (int a = last + 1, end = FloorDiv(t + hi - 1, TILE_SIZE); a <= end; ++a) {
+            uint8_t bits = line(a);
+            if (bits & blocking) {
+                return result(std::max(along, static_cast<double>(a * TILE_SIZE - hi)));
+            }
+            touched |= bits;
+        }
+    } else {
+        for (int a = first - 1, end = FloorDiv(t + lo, TILE_SIZE); a >= end; --a) {
+            uint8_t bits = line(a);
+            if (bits & blocking) {
+                return result(std::min(along, static_cast<double>((a + 1) * TILE_SIZE - lo)));
+            }
+            touched |= bits;
+        }
+    }
+    return result(target);
+}
@@ -0,0 +1,35 @@
+#ifndef MAIN_COLLISION_H
+#define MAIN_COLLISION_H
+
+#include "Room.h"
+#include "structs.hpp"
+
+#include <array>
+#include <cstdint>
+
+// CELL_* bits of every cell of a room, row by row
+using CellGrid = std::array<uint8_t, MAP_WIDTH * MAP_HEIGHT>;
+
+CellGrid BuildCellGrid(const std::array<char[MAP_WIDTH + 1], MAP_HEIGHT> &objects);
+// bits of the cell at column col, row row; outside the room counts as wall
+uint8_t CellAt(const CellGrid &cells, int col, int row);
+
+// an entity's hitbox in pixels, relative to its position, half-open
+struct HitBox {
+    int x0, y0, x1, y1;
+};
+
+// the cell under the centre of the box
+Point<int> BoxCell(Point<double> pos, const HitBox &box);
+// bits of all cells the box overlaps
+uint8_t BoxBits(const CellGrid &cells, Point<double> pos, const HitBox &box);
+
+// Moves a box from pos by dist pixels in dir, visiting every column (or row) of cells it
+// crosses on the way, so no distance tunnels through a wall. Stops flush against the
+// first cell with a blocking bit and returns the furthest legal position. touched gets
+// the other bits of all cells the box covered from start to finish.
+// The box at pos must not overlap a blocking cell already.
+Point<double> SweepBox(const CellGrid &cells, Point<double> pos, const HitBox &box,
+                       Direction dir, double dist, uint8_t blocking, uint8_t &touched);
+
+#endif  // MAIN_COLLISION_H
@@ -0,0 +1,14 @@
+#include "DrawCommands.h"
+
+void DrawCommands::SortByLayer() {
+    // insertion sort: a frame is a few dozen commands, nearly always in order
+    // already, and unlike std::stable_sort this needs no scratch buffer
+    for (size_t i = 1; i < commands_.size(); ++i) {
+        DrawCommand cmd = commands_[i];
+        size_t j = i;
+        for (; j > 0 && commands_[j - 1].layer > cmd.layer; --j) {
+            commands_[j] = commands_[j - 1];
+        }
+        commands_[j] = cmd;
+    }
+}
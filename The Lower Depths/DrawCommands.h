@@ -0,0 +1,51 @@
+#ifndef MAIN_DRAW_COMMANDS_H
+#define MAIN_DRAW_COMMANDS_H
+
+#include "Image.h"
+#include "Blend.h"
+#include "structs.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Back to front; Game::DrawList() emits commands in this order already
+enum class DrawLayer : uint8_t {BACKGROUND, WORLD, EFFECT, HUD, SCREEN};
+
+struct DrawCommand {
+    Point<int> pos;      // top-left corner in game pixels
+    const Image *image;  // owned by the Game, valid until the next DrawList()
+    BlendMode mode;
+    DrawLayer layer;
+};
+
+// Frame-scoped list of draw commands in contiguous storage. Reset() keeps the
+// capacity, so once it has grown to a frame's size recording allocates nothing.
+class DrawCommands {
+public:
+    void Reset() { commands_.clear(); }
+    void Push(Point<int> pos, const Image &image, DrawLayer layer, BlendMode mode = BlendMode::ALPHA) {
+        commands_.push_back({pos, &image, mode, layer});
+    }
+    // stable: commands within a layer keep their recording order
+    void SortByLayer();
+
+    const DrawCommand *begin() const { return commands_.data(); }
+    const DrawCommand *end() const { return commands_.data() + commands_.size(); }
+    const DrawCommand &operator [](size_t i) const { return commands_[i]; }
+    size_t size() const { return commands_.size(); }
+    bool empty() const { return commands_.empty(); }
+
+private:
+    std::vector<DrawCommand> commands_;
+};
+
+// Everything a renderer needs for one frame, so it can draw without touching the Game
+// (which may be simulating the next frames on another thread meanwhile)
+struct FrameSnapshot {
+    DrawCommands commands;
+    std::shared_ptr<const Image> background;  // held, so a room change can't free it mid-draw
+    double fade = -1;                         // Game::RoomFade()
+};
+
+#endif  // MAIN_DRAW_COMMANDS_H
@@ -0,0 +1,112 @@
+#include "Entities.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENTITIES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// facing from the signs of the offsets: x wins over y, no move keeps the old one;
+// dir = UP + [down] for y and LEFT + [right] for x, which flee flips
+inline Direction Facing(Direction old, int x_moved, int x_neg, int y_moved, int y_neg, int flee) {
+    int vertical = to_underlying(Direction::UP) + (y_neg ^ 1 ^ flee);
+    int horizontal = to_underlying(Direction::LEFT) + (x_neg ^ 1 ^ flee);
+    int dir = to_underlying(old);
+    dir = (dir & ~-y_moved) | (vertical & -y_moved);
+    dir = (dir & ~-x_moved) | (horizontal & -x_moved);
+    return static_cast<Direction>(dir);
+}
+
+inline double ChaseDelta(double off, double step, bool flee) {
+    if (flee) {
+        return (off < 0) * step - (off > 0) * step;
+    }
+    return std::min(std::max(off, -step), step);
+}
+
+}  // namespace
+
+void Entities::Clear() {
+    for (auto *coords : {&x, &y, &prev_x, &prev_y}) {
+        coords->clear();
+    }
+    px.clear();
+    py.clear();
+    dir.clear();
+    phase.clear();
+    alive.clear();
+}
+
+size_t Entities::Add(Point<int> pos, Direction facing, uint8_t anim_phase) {
+    x.push_back(pos.x);
+    y.push_back(pos.y);
+    prev_x.push_back(pos.x);
+    prev_y.push_back(pos.y);
+    px.push_back(pos.x);
+    py.push_back(pos.y);
+    dir.push_back(facing);
+    phase.push_back(anim_phase);
+    alive.push_back(1);
+    return Size() - 1;
+}
+
+void Entities::Place(size_t i, Point<double> pos) {
+    x[i] = pos.x;
+    y[i] = pos.y;
+    px[i] = static_cast<int>(pos.x);
+    py[i] = static_cast<int>(pos.y);
+}
+
+void Entities::BeginTick() {
+    std::copy(x.begin(), x.end(), prev_x.begin());
+    std::copy(y.begin(), y.end(), prev_y.begin());
+}
+
+bool ChaseStraight(Entities &e, size_t first, size_t last, Point<double> target, Point<int> target_px,
+                   double step, bool flee) {
+    size_t i = first;
+    int contact = 0;
+#ifdef ENTITIES_SSE2
+    const __m128d tx = _mm_set1_pd(target.x), ty = _mm_set1_pd(target.y);
+    const __m128d pos_step = _mm_set1_pd(step), neg_step = _mm_set1_pd(-step), zero = _mm_setzero_pd();
+    const __m128d flee_mask = _mm_castsi128_pd(_mm_set1_epi32(flee ? -1 : 0));
+    const __m128i tpx = _mm_set1_epi32(target_px.x), tpy = _mm_set1_epi32(target_px.y);
+    // chase: the offset clamped to step; flee: step against the offset's sign
+    auto delta = [&](__m128d off) {
+        __m128d chase = _mm_min_pd(_mm_max_pd(off, neg_step), pos_step);
+        __m128d away = _mm_sub_pd(_mm_and_pd(_mm_cmplt_pd(off, zero), pos_step),
+                                  _mm_and_pd(_mm_cmpgt_pd(off, zero), pos_step));
+        return _mm_or_pd(_mm_and_pd(flee_mask, away), _mm_andnot_pd(flee_mask, chase));
+    };
+    for (; i + 2 <= last; i += 2) {
+        __m128d x = _mm_loadu_pd(&e.x[i]), y = _mm_loadu_pd(&e.y[i]);
+        __m128d off_x = _mm_sub_pd(tx, x), off_y = _mm_sub_pd(ty, y);
+        x = _mm_add_pd(x, delta(off_x));
+        y = _mm_add_pd(y, delta(off_y));
+        _mm_storeu_pd(&e.x[i], x);
+        _mm_storeu_pd(&e.y[i], y);
+        __m128i px = _mm_cvttpd_epi32(x), py = _mm_cvttpd_epi32(y);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(&e.px[i]), px);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(&e.py[i]), py);
+        __m128i hit = _mm_and_si128(_mm_cmpeq_epi32(px, tpx), _mm_cmpeq_epi32(py, tpy));
+        contact |= _mm_movemask_epi8(hit) & 0xFF;
+
+        int x_moved = _mm_movemask_pd(_mm_cmpneq_pd(off_x, zero)), x_neg = _mm_movemask_pd(_mm_cmplt_pd(off_x, zero));
+        int y_moved = _mm_movemask_pd(_mm_cmpneq_pd(off_y, zero)), y_neg = _mm_movemask_pd(_mm_cmplt_pd(off_y, zero));
+        for (int lane = 0; lane < 2; ++lane) {
+            e.dir[i + lane] = Facing(e.dir[i + lane], x_moved >> lane & 1, x_neg >> lane & 1,
+                                     y_moved >> lane & 1, y_neg >> lane & 1, flee);
+        }
+    }
+#endif
+    for (; i < last; ++i) {
+        double off_x = target.x - e.x[i], off_y = target.y - e.y[i];
+        e.Place(i, {e.x[i] + ChaseDelta(off_x, step, flee), e.y[i] + ChaseDelta(off_y, step, flee)});
+        e.dir[i] = Facing(e.dir[i], off_x != 0, off_x < 0, off_y != 0, off_y < 0, flee);
+        contact |= e.px[i] == target_px.x && e.py[i] == target_px.y;
+    }
+    return contact != 0;
+}
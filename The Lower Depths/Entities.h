@@ -0,0 +1,39 @@
+#ifndef MAIN_ENTITIES_H
+#define MAIN_ENTITIES_H
+
+#include "structs.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Structure-of-arrays store for one kind of room entity (guards, holes, pearls).
+// Entity i is index i of every component array; systems walk the arrays they need
+// front to back, which keeps them linear in memory and open to vectorisation.
+struct Entities {
+    std::vector<double> x, y;            // exact position, pixels
+    std::vector<double> prev_x, prev_y;  // at the start of the tick, for interpolation
+    std::vector<int> px, py;             // whole pixels: what collisions and drawing use
+    std::vector<Direction> dir;          // facing
+    std::vector<uint8_t> phase;          // animation rate or offset, meaning is per kind
+    std::vector<uint8_t> alive;          // 0 once taken or gone; the slot stays
+
+    size_t Size() const { return x.size(); }
+    void Clear();
+    size_t Add(Point<int> pos, Direction facing = Direction::DOWN, uint8_t anim_phase = 0);
+
+    Point<double> Pos(size_t i) const { return {x[i], y[i]}; }
+    Point<int> PixelPos(size_t i) const { return {px[i], py[i]}; }
+    // sets the exact position and the whole pixel one from it
+    void Place(size_t i, Point<double> pos);
+    // remembers every position as the start of the tick
+    void BeginTick();
+};
+
+// Moves entities [first, last) straight at target, like Point::Shift with no collisions:
+// along each axis by the offset clamped to step, or by exactly step away from target when
+// flee. Each faces along the last axis it moved on (x after y). Two entities per SSE2
+// vector, no per-entity branches. Returns whether any ends on target_px.
+bool ChaseStraight(Entities &e, size_t first, size_t last, Point<double> target, Point<int> target_px,
+                   double step, bool flee);
+
+#endif  // MAIN_ENTITIES_H
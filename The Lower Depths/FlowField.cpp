@@ -0,0 +1,42 @@
+#include "FlowField.h"
+
+void FlowField::Build(const CellGrid &cells, Point<int> target, uint8_t blocking) {
+    next_.fill(unreachable_);
+    target_ = target;
+    valid_ = true;
+    if (CellAt(cells, target.x, target.y) & blocking) {
+        return;
+    }
+    // BFS outwards from the target: a cell reached from a neighbour steps back towards it
+    std::array<uint16_t, MAP_WIDTH * MAP_HEIGHT> queue;
+    size_t head = 0, tail = 0;
+    next_[target.y * MAP_WIDTH + target.x] = arrived_;
+    queue[tail++] = target.y * MAP_WIDTH + target.x;
+    while (head < tail) {
+        int cell = queue[head++];
+        Point<int> from{cell % MAP_WIDTH, cell / MAP_WIDTH};
+        for (Direction dir : {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT}) {
+            Point<int> to = from.Shift(dir, 1);
+            if (CellAt(cells, to.x, to.y) & blocking) {
+                continue;  // also covers cells outside the room
+            }
+            uint8_t &next = next_[to.y * MAP_WIDTH + to.x];
+            if (next == unreachable_) {
+                next = to_underlying(Opposite(dir));
+                queue[tail++] = to.y * MAP_WIDTH + to.x;
+            }
+        }
+    }
+}
+
+bool FlowField::Next(Point<int> cell, Direction &dir) const {
+    if (cell.x < 0 || cell.y < 0 || cell.x >= MAP_WIDTH || cell.y >= MAP_HEIGHT) {
+        return false;
+    }
+    uint8_t next = next_[cell.y * MAP_WIDTH + cell.x];
+    if (next == unreachable_ || next == arrived_) {
+        return false;
+    }
+    dir = static_cast<Direction>(next);
+    return true;
+}
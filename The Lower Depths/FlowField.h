@@ -0,0 +1,31 @@
+#ifndef MAIN_FLOW_FIELD_H
+#define MAIN_FLOW_FIELD_H
+
+#include "Collision.h"
+#include "structs.hpp"
+
+#include <array>
+#include <cstdint>
+
+// Shortest paths from every cell of a room to one target cell, found by a BFS over the
+// cells without blocking bits. Built once per target; looking up where to go from a
+// cell is O(1), so any number of entities can follow it.
+class FlowField {
+public:
+    void Build(const CellGrid &cells, Point<int> target, uint8_t blocking);
+
+    bool Valid() const { return valid_; }
+    Point<int> Target() const { return target_; }
+    // the first step of a shortest path from cell to the target;
+    // false at the target itself and where the target can't be reached
+    bool Next(Point<int> cell, Direction &dir) const;
+
+private:
+    constexpr static uint8_t unreachable_ = 0xff, arrived_ = 0xfe;
+
+    std::array<uint8_t, MAP_WIDTH * MAP_HEIGHT> next_{};  // a Direction, or one of the above
+    Point<int> target_{-1, -1};
+    bool valid_ = false;
+};
+
+#endif  // MAIN_FLOW_FIELD_H
@@ -1,62 +1,74 @@
 #include "Game.h"
+#include "AssetLoader.h"
 
+#include<algorithm>
 #include<fstream>
 #include<map>
 #include<cstring>
 
 Game::Game() {
     path_ = "../map_design/";
-    for (int i = 0; i < tiles.size(); ++i) {
-        tiles[i] = Image(path_ + "tiles/" + std::to_string(i) + ".png");
-    }
+    if (!bundle_.Open(path_ + "assets.bundle")) {
+        std::cerr << "No asset bundle in " << path_ << ", decoding PNGs (build the `assets` target)" << std::endl;
+    }
+    // PNG decodes (or bundle views) of all assets fan out over the pool and join before LabInit()
+    ThreadPool pool;
+    AssetLoader loader;
+    auto load = [&](const char *asset_class, Image &dst, const std::string &name) {
+        loader.Add(asset_class, [this, &dst, name] {
+            dst = bundle_.IsOpen() ? bundle_.View(name) : Image(path_ + name + ".png");
+        });
+    };
+    if (bundle_.IsOpen()) {
+        tile_atlas_ = bundle_.View(ATLAS_NAME);
+        for (int i = 0; i < tiles.size(); ++i) {
+            tiles[i] = AtlasTile(tile_atlas_, i);
+        }
+    }  // otherwise tiles are decoded lazily by Tile()
     std::array<const char*, 4> dir_str{"up", "down", "left", "right"};
     for (int dir = 0; dir < 4; ++dir) {
         for (int i = 0; i < player_sprite[0].size(); ++i) {
-            player_sprite[dir][i] = Image(path_ + "sprites/player_" + 
-                    dir_str[dir] + "_" +  std::to_string(i) + ".png");
+            load("player_sprite", player_sprite[dir][i], "sprites/player_" + 
+                    std::string(dir_str[dir]) + "_" +  std::to_string(i));
         }
     }
     for (int dir = 0; dir < 4; ++dir) {
         for (int i = 0; i < guard_sprite[0].size(); ++i) {
-            guard_sprite[dir][i] = Image(path_ + "sprites/guard_" + 
-                    dir_str[dir] + "_" +  std::to_string(i) + ".png");
+            load("guard_sprite", guard_sprite[dir][i], "sprites/guard_" + 
+                    std::string(dir_str[dir]) + "_" +  std::to_string(i));
         }
     }
     for (int i = 0; i < hole_tile.size(); ++i) {
-        hole_tile[i] = Image(path_ + "objects/hole" + std::to_string(i) + ".png");
+        load("hole_tile", hole_tile[i], "objects/hole" + std::to_string(i));
     }
     for (int i = 0; i < health_bar.size(); ++i) {
-        health_bar[i] = Image(path_ + "objects/hb" + std::to_string(i) + ".png");
+        load("health_bar", health_bar[i], "objects/hb" + std::to_string(i));
     }
     for (int i = 0; i < free_pearl_tile.size(); ++i) {
-        free_pearl_tile[i] = Image(path_ + "objects/pearl_16_" + std::to_string(i) + ".png");
+        load("free_pearl_tile", free_pearl_tile[i], "objects/pearl_16_" + std::to_string(i));
     }
-    pearl_inv_tile = Image(path_ + "objects/pearl_glow.png");
+    load("free_pearl_tile", pearl_inv_tile, "objects/pearl_glow");
     for (int i = 0; i < lightning_effect.size(); ++i) {
-        lightning_effect[i] = Image(path_ + "objects/lightning" + std::to_string(i) + ".png");
+        load("lightning_effect", lightning_effect[i], "objects/lightning" + std::to_string(i));
     }
-    gameover_img = Image(path_ + "objects/game_over.png");
-    win_img = Image(path_ + "objects/game_win.png");
-    rules_img = Image(path_ + "objects/game_begin.png");
+    load("screens", gameover_img, "objects/game_over");
+    load("screens", win_img, "objects/game_win");
+    load("screens", rules_img, "objects/game_begin");
+    loader.Run(pool);
     LabInit();
     RoomInit();
 }
 
 void Game::LabInit() {
-    std::ifstream fin;
-    fin.open(path_ + "Lab.mashgraph");
-    for (int i = 0; i < LAB_SIZE; ++i) {
-        fin.getline(lab[i], LAB_SIZE + 1);
-        auto p_init_room = std::strchr(lab[i], '@');
-        if (p_init_room) {
-            cur_room_ = {static_cast<int>(p_init_room - lab[i]), i};
-        }
-    }
+    lab_.Open(path_ + "Lab.mashgraph");
+    cur_room_ = lab_.Start();
     new_room_ = cur_room_;
 }
 
 void Game::RoomInit() {
-    RoomDraw();
+    PreparedRoom prepared = room_loader_.Get(RoomType());
+    room_ = prepared.data;
+    background_ = prepared.background;
     RoomEquip();
     if (state_ == GameState::PLAY) {
         RoomFindPos();
@@ -64,6 +76,21 @@ void Game::RoomInit() {
         state_ = GameState::PLAY;
     }
     player_pos_real_ = player_pos_;
+    player_pos_prev_ = player_pos_real_;  // no interpolating across rooms
+    PrefetchNeighbours();
+}
+
+char Game::LabCell(Point<int> room) const {
+    return lab_.Cell(room);
+}
+
+void Game::PrefetchNeighbours() {
+    for (Direction dir : {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT}) {
+        char type = LabCell(cur_room_.Shift(dir, 1));
+        if (type != '-') {
+            room_loader_.Request(type, false);
+        }
+    }
 }
 
 void Game::RoomChangeCheck() {
@@ -119,54 +146,76 @@ void Game::RoomFindPos() {
     }
 }
 
-void Game::RoomDraw() {
-    std::ifstream fin_back, fin_items;
-    fin_back.open(path_ + "rooms/" + RoomType() + "_back.csv");
-    fin_items.open(path_ + "rooms/" + RoomType() + "_items.csv");
-    for (int y = 0; y < MAP_HEIGHT * TILE_SIZE; y += TILE_SIZE) {
-        for (int x = 0; x < MAP_WIDTH * TILE_SIZE; x += TILE_SIZE) {
-            int tile_num;
-            fin_back >> tile_num;
-            background_.PutTile(x, y, tiles[tile_num]);
-            fin_items >> tile_num;
-            if (tile_num > 0 && tile_num != HOLE_MAP_TILE && tile_num != GUARD_MAP_TILE) {
-                background_.PutTileOver(x, y, tiles[tile_num]);
+std::shared_ptr<const Image> Game::Tile(int n) {
+    if (bundle_.IsOpen()) {
+        // resident in the mapping already: a non-owning pointer to the atlas view
+        return std::shared_ptr<const Image>(std::shared_ptr<const Image>(), &tiles[n]);
+    }
+    return tile_cache_.GetOrLoad(n,
+        [&] { return std::make_shared<const Image>(path_ + "tiles/" + std::to_string(n) + ".png"); },
+        [](const Image &tile) { return tile.size(); });
+}
+
+std::shared_ptr<const RoomData> Game::LoadRoom(char type) const {
+    auto room = std::make_shared<RoomData>();
+    std::string rooms_dir = path_ + "rooms/";
+    if (!room->Load(rooms_dir + type + ".room")) {
+        std::cerr << "No compiled room " << type << ", parsing text sources" << std::endl;
+        room->ParseText(rooms_dir, type);
+    }
+    return room;
+}
+
+// runs on the room loader thread as well as the main one: only touches the thread-safe caches
+PreparedRoom Game::PrepareRoom(char type) {
+    PreparedRoom room;
+    room.data = rooms_.GetOrLoad(type, [&] { return LoadRoom(type); },
+                                 [](const RoomData &) { return sizeof(RoomData); });
+    // room types repeat across the lab, so a transition is usually just a cache hit
+    room.background = backgrounds_.GetOrLoad(type,
+        [&] { return std::make_shared<const Image>(ComposeBackground(*room.data)); },
+        [](const Image &background) { return background.size(); });
+    return room;
+}
+
+Image Game::ComposeBackground(const RoomData &room) {
+    Image background(MAP_WIDTH * TILE_SIZE, MAP_HEIGHT * TILE_SIZE);
+    auto tile = [this](uint16_t cell) {
+        auto img = Tile(cell & ROOM_TILE_INDEX);
+        return (cell & ROOM_TILE_FLIPS) ? std::make_shared<const Image>(OrientTile(*img, cell)) : img;
+    };
+    for (int i = 0; i < MAP_HEIGHT; ++i) {
+        for (int j = 0; j < MAP_WIDTH; ++j) {
+            background.PutTile(j * TILE_SIZE, i * TILE_SIZE, *tile(room.back[i * MAP_WIDTH + j]));
+            if (uint16_t item = room.items[i * MAP_WIDTH + j]) {
+                background.PutTileOver(j * TILE_SIZE, i * TILE_SIZE, *tile(item));
             }
         }
     }
-    fin_back.close();
-    fin_items.close();
+    return background;
 }
 
 void Game::RoomEquip() {
-    holes.clear();
-    guards.clear();
-    bool init_pearls = pearls.find(CurRoomMap()) == pearls.end();
-    std::ifstream fin;
-    fin.open(path_ + "rooms/" + RoomType() + ".mashgraph");
-    for (int i = 0; i < MAP_HEIGHT; ++i) {
-        fin.getline(objects[i], MAP_WIDTH + 1);
-        char *p_hole = std::strchr(objects[i], 'h');
-        if (p_hole) {
-            int idx = p_hole - objects[i];
-            // < 2 holes in a row
-            holes.push_back({idx * TILE_SIZE, i * TILE_SIZE});
-        }
-        char *p_guard = std::strchr(objects[i], 'g');
-        // < 2 guards in a row
-        if (p_guard) {
-            Point<int> guard_pos = {static_cast<int>(p_guard - objects[i]) * TILE_SIZE, i * TILE_SIZE};
-            guards.push_back({guard_pos, Direction::DOWN, guard_pos});
-        }
-        if (init_pearls) {
-            char *p_pearl = std::strchr(objects[i], 'p');
-            int idx = p_pearl - objects[i];
-            if (p_pearl && (pearls[CurRoomMap()].empty() || (pearls[CurRoomMap()].back().first.x != idx * TILE_SIZE - 8))) {
-                pearls[CurRoomMap()].push_back({{idx * TILE_SIZE - 8, i * TILE_SIZE - 8}, true});
-            }
+    objects = room_->objects;
+    cells_ = BuildCellGrid(objects);
+    guard_flow_ = FlowField();
+    holes_.Clear();
+    for (size_t i = 0; i < room_->holes.size(); ++i) {
+        holes_.Add(room_->holes[i], Direction::DOWN, static_cast<uint8_t>(i + 1));
+    }
+    guards_.Clear();
+    for (Point<int> guard_pos : room_->guards) {
+        guards_.Add(guard_pos);
+    }
+    guard_grid_.Build(guards_);
+    auto [room_pearls, first_visit] = pearls_by_room_.try_emplace(CurRoomMap());
+    pearls_ = &room_pearls->second;
+    if (first_visit) {
+        for (Point<int> pearl_pos : room_->pearls) {
+            pearls_->Add(pearl_pos);
         }
     }
-    fin.close();
+    pearl_grid_.Build(*pearls_);
 }
 
 void Game::Move(Direction dir) {
@@ -174,20 +223,13 @@ void Game::Move(Direction dir) {
         return;
     }
     idle_ = false;
-    Point<double> desired_pos_real = player_pos_real_.Shift(dir, mean_delta_ * player_speed_);
+    // walls stop the player flush against them; everything else passed on the way counts
+    uint8_t collisions;
+    Point<double> desired_pos_real = SweepBox(cells_, player_pos_real_, player_box_, dir,
+                                              TICK * player_speed_, CELL_WALL, collisions);
     player_dir_ = dir;
     Point<int> desired_pos = desired_pos_real;
-    std::map<char, bool> collisions;
-    for (int dy : {16, 32, 40}) {
-        for (int dx: {0, 16, 18}) {
-            char c = objects[(desired_pos.y + dy) / TILE_SIZE][(desired_pos.x + dx) / TILE_SIZE];
-            collisions[c] = true;
-        }
-    }
-    if (collisions['#']) {
-        return;
-    }
-    if (collisions['c'] && (time_ > last_coral_hit_ + coral_cd_) && (time_ > last_pearl_activated_ + pearl_cd_)) {
+    if ((collisions & CELL_CORAL) && (time_ > last_coral_hit_ + coral_cd_) && (time_ > last_pearl_activated_ + pearl_cd_)) {
         last_coral_hit_ = time_;
         --health_;
         if (health_ == 0) {
@@ -195,34 +237,26 @@ void Game::Move(Direction dir) {
             return;
         }
     }
-    if (collisions['h'] && (time_ > last_pearl_activated_ + pearl_cd_)) {
+    if ((collisions & CELL_HOLE) && (time_ > last_pearl_activated_ + pearl_cd_)) {
         state_ = GameState::OVER;
         return;
     }
-    if (collisions['x']) {
+    if (collisions & CELL_EXIT) {
         new_room_ = cur_room_.Shift(dir, 1);
+        room_loader_.Request(LabCell(new_room_), true);  // ready by the end of the fade-out
         room_time_ = 0;
         room_change_begin_ = time_;
         room_state_ = RoomState::FADEOUT;
         return;
     }
-    if (collisions['Q']) {
+    if (collisions & CELL_GOAL) {
         state_ = GameState::WIN;
         return;
     }
-    if (collisions['p']) {
-        auto it = pearls[CurRoomMap()].begin();
-        int min_dist = desired_pos.SqrDist(it->first);
-        auto min_it = it;
-        while (++it != pearls[CurRoomMap()].end()) {
-            int cur_dist = desired_pos.SqrDist(it->first);
-            if (cur_dist < min_dist) { 
-                min_dist = cur_dist;
-                min_it = it;
-            }
-        }
-        if (min_it->second && pearl_num_ < max_pearls_) {
-            min_it->second = false;
+    size_t nearest;
+    if ((collisions & CELL_PEARL) && pearl_grid_.Nearest(*pearls_, desired_pos, pearl_reach_, nearest)) {
+        if (pearls_->alive[nearest] && pearl_num_ < max_pearls_) {
+            pearls_->alive[nearest] = 0;
             ++pearl_num_;
         }
     }
@@ -234,32 +268,78 @@ void Game::MoveGuards() {
     if (room_state_ != RoomState::NORMAL) {
         return;
     }
-    double step = mean_delta_ * guard_speed_;
-    if (last_pearl_activated_ + pearl_cd_ > time_) {
-        step = -step * 2;
-    }
-    for (auto &[guard_pos, guard_dir, guard_pos_real]: guards) {
-        if (guard_pos_real.y > player_pos_real_.y) {
-            guard_pos_real.y -=step;
-            guard_dir = Direction::UP;
-        } else if (guard_pos_real.y < player_pos_real_.y) {
-            guard_pos_real.y += step;
-            guard_dir = Direction::DOWN;
-        }
-        if (guard_pos_real.x > player_pos_real_.x) {
-            guard_pos_real.x -= step;
-            guard_dir = Direction::LEFT;
-        } else if (guard_pos_real.x < player_pos_real_.x) {
-            guard_pos_real.x += step;
-            guard_dir = Direction::RIGHT;
-        }
-        guard_pos = guard_pos_real;
-        if (player_pos_ == guard_pos) {
-            state_ = GameState::OVER;
+    bool flee = last_pearl_activated_ + pearl_cd_ > time_;
+    double step = TICK * guard_speed_ * (flee ? 2 : 1);
+    Point<int> target = BoxCell(player_pos_real_, player_box_);
+    if (!guard_flow_.Valid() || !(guard_flow_.Target() == target)) {
+        guard_flow_.Build(cells_, target, guard_blocking_);
+    }
+    auto walk = [&](Point<double> pos, Direction dir, double dist) {
+        uint8_t touched;
+        return SweepBox(cells_, pos, guard_box_, dir, dist, guard_blocking_, touched);
+    };
+    // guards spawn inside the rock and seep out of it straight at the player; once in the open
+    // they keep to it. Runs of guards still in the rock go through the ChaseStraight kernel
+    auto in_rock = [&](size_t i) { return BoxBits(cells_, guards_.Pos(i), guard_box_) & guard_blocking_; };
+    bool contact = false;
+    for (size_t i = 0; i < guards_.Size(); ++i) {
+        if (in_rock(i)) {
+            size_t run_end = i + 1;
+            while (run_end < guards_.Size() && in_rock(run_end)) {
+                ++run_end;
+            }
+            contact |= ChaseStraight(guards_, i, run_end, player_pos_real_, player_pos_, step, flee);
+            i = run_end - 1;
+            continue;
         }
+        Point<double> guard_pos_real = guards_.Pos(i);
+        Direction &guard_dir = guards_.dir[i];
+        Point<int> cell = BoxCell(guard_pos_real, guard_box_);
+        Direction dir;
+        if (guard_flow_.Next(cell, dir)) {
+            if (flee) {
+                dir = Opposite(dir);
+            }
+            // keep the box centred across the way it walks, so it fits through gaps one cell wide
+            bool horizontal = dir == Direction::LEFT || dir == Direction::RIGHT;
+            double centre = horizontal ? (cell.y + 0.5) * TILE_SIZE - (guard_box_.y0 + guard_box_.y1) / 2.0
+                                       : (cell.x + 0.5) * TILE_SIZE - (guard_box_.x0 + guard_box_.x1) / 2.0;
+            double off = centre - (horizontal ? guard_pos_real.y : guard_pos_real.x);
+            if (off != 0) {
+                Direction side = horizontal ? (off < 0 ? Direction::UP : Direction::DOWN)
+                                            : (off < 0 ? Direction::LEFT : Direction::RIGHT);
+                guard_pos_real = walk(guard_pos_real, side, std::min(step, std::abs(off)));
+            }
+            guard_pos_real = walk(guard_pos_real, dir, step);
+            guard_dir = dir;
+        } else if (cell == target) {
+            // straight at the player (or away from them), as guards always moved before
+            for (bool horizontal : {false, true}) {
+                double off = horizontal ? player_pos_real_.x - guard_pos_real.x : player_pos_real_.y - guard_pos_real.y;
+                if (off == 0) {
+                    continue;
+                }
+                dir = ChaseDir(guard_pos_real, horizontal);
+                guard_dir = flee ? Opposite(dir) : dir;
+                double dist = flee ? step : std::min(step, std::abs(off));
+                guard_pos_real = walk(guard_pos_real, guard_dir, dist);
+            }
+        }  // no way to the player from here: stand still
+        guards_.Place(i, guard_pos_real);
+    }
+    guard_grid_.Update(guards_);
+    if (contact || guard_grid_.AnyWithin(guards_, player_pos_, guard_contact_)) {
+        state_ = GameState::OVER;
     }
 }
 
+Direction Game::ChaseDir(Point<double> from, bool horizontal) const {
+    if (horizontal) {
+        return player_pos_real_.x < from.x ? Direction::LEFT : Direction::RIGHT;
+    }
+    return player_pos_real_.y < from.y ? Direction::UP : Direction::DOWN;
+}
+
 void Game::ActivatePearl() {
     if (pearl_num_ == 0) {
         return;
@@ -272,14 +352,43 @@ void Game::ActivatePearl() {
     --pearl_num_;
 }
 
-void Game::UpdTime(double current_time) {
+int Game::UpdTime(double current_time) {
     if (current_time - last_fps_info_ > 10) {
-        std::cout << "Mean FPS: " << 1 / mean_delta_ << "; current delta: " << 1 / (current_time - time_) << std::endl;
+        std::cout << "Mean FPS: " << 1 / mean_delta_ << "; current delta: " << 1 / (current_time - frame_time_) << std::endl;
+        auto print_stats = [](const char *name, const CacheStats &stats) {
+            std::cout << name << " cache: " << stats.entries << " entries, " << stats.bytes << " bytes; "
+                      << stats.hits << " hits, " << stats.misses << " misses, "
+                      << stats.evictions << " evictions" << std::endl;
+        };
+        if (!bundle_.IsOpen()) {
+            print_stats("Tile", tile_cache_.Stats());
+        }
+        print_stats("Background", backgrounds_.Stats());
+        print_stats("Lab chunk", lab_.Stats());
         last_fps_info_ = current_time;
     }
     ++counter_;
-    time_ = current_time;
+    tick_lag_ += current_time - frame_time_;
+    frame_time_ = current_time;
     mean_delta_ = current_time / counter_;
+    int ticks = static_cast<int>(tick_lag_ / TICK);
+    if (ticks > max_ticks_per_frame_) {
+        ticks = max_ticks_per_frame_;  // catching up would only make the next frame later
+        tick_lag_ = ticks * TICK;
+    }
+    tick_lag_ -= ticks * TICK;
+    return ticks;
+}
+
+void Game::BeginTick() {
+    time_ += TICK;
+    player_pos_prev_ = player_pos_real_;
+    guards_.BeginTick();
+}
+
+Point<int> Game::Interpolate(Point<double> prev, Point<double> cur) const {
+    double alpha = tick_lag_ / TICK;
+    return Point<double>{prev.x + (cur.x - prev.x) * alpha, prev.y + (cur.y - prev.y) * alpha};
 }
 
 int discrete_wave(double x, int p, double a) {
@@ -295,44 +404,53 @@ int lightning_idx(double time_, double a) {
     }
 }
 
-std::list<std::pair<Point<int>, const Image &>> Game::DrawList() {
-    std::list<std::pair<Point<int>, const Image &>> draw_list{{{0, 0}, background_}};
+void Game::Snapshot(FrameSnapshot &frame) {
+    frame.commands = DrawList();
+    frame.background = background_;
+    frame.fade = RoomFade();
+}
+
+const DrawCommands &Game::DrawList() {
+    draw_list_.Reset();
+    draw_list_.Push({0, 0}, *background_, DrawLayer::BACKGROUND);
     if (time_ > last_pearl_activated_ + pearl_cd_) {
-        for (int i = 0; i < holes.size(); ++i) {
-            draw_list.push_back({holes[i], hole_tile[discrete_wave(time_, hole_tile.size() - 1, 10 * (i + 1))]});
+        for (size_t i = 0; i < holes_.Size(); ++i) {
+            draw_list_.Push(holes_.PixelPos(i), hole_tile[discrete_wave(time_, hole_tile.size() - 1, 10 * holes_.phase[i])], DrawLayer::WORLD);
         }
     }
     unsigned sprite_state = discrete_wave(time_, 2, 2);
+    Point<int> player_pos = Interpolate(player_pos_prev_, player_pos_real_);
     if (state_ != GameState::OVER) {
         if (time_ < last_coral_hit_ + coral_cd_) {
-            draw_list.push_back({player_pos_, player_sprite[to_underlying(player_dir_)][discrete_wave(time_, 2, 10)]});
+            draw_list_.Push(player_pos, player_sprite[to_underlying(player_dir_)][discrete_wave(time_, 2, 10)], DrawLayer::WORLD);
         }
         else {
-            draw_list.push_back({player_pos_, player_sprite[to_underlying(player_dir_)][sprite_state]});
+            draw_list_.Push(player_pos, player_sprite[to_underlying(player_dir_)][sprite_state], DrawLayer::WORLD);
         }
     }
-    for (auto &[pearl_pos, is_free]: pearls[CurRoomMap()]) {
-        if (is_free) {
-            draw_list.push_back({pearl_pos, free_pearl_tile[static_cast<int>(time_ * 10) % free_pearl_tile.size()]});
+    for (size_t i = 0; i < pearls_->Size(); ++i) {
+        if (pearls_->alive[i]) {
+            draw_list_.Push(pearls_->PixelPos(i), free_pearl_tile[static_cast<int>(time_ * 10) % free_pearl_tile.size()], DrawLayer::WORLD);
         }
     }
-    for (auto &[guard_pos, guard_dir, guard_pos_real]: guards) {
-        draw_list.push_back({guard_pos, guard_sprite[to_underlying(guard_dir)][sprite_state]});
+    for (size_t i = 0; i < guards_.Size(); ++i) {
+        draw_list_.Push(Interpolate({guards_.prev_x[i], guards_.prev_y[i]}, guards_.Pos(i)),
+                        guard_sprite[to_underlying(guards_.dir[i])][sprite_state], DrawLayer::WORLD);
     }
     if (time_ < last_pearl_activated_ + pearl_cd_) {
-        draw_list.push_back({{player_pos_.x + 9 - MAP_WIDTH * TILE_SIZE, player_pos_.y + 20 - MAP_HEIGHT * TILE_SIZE},
-                             lightning_effect[lightning_idx(time_, 8)]});
+        draw_list_.Push({player_pos.x + 9 - MAP_WIDTH * TILE_SIZE, player_pos.y + 20 - MAP_HEIGHT * TILE_SIZE},
+                        lightning_effect[lightning_idx(time_, 8)], DrawLayer::EFFECT, BlendMode::EFFECT);
     }
-    draw_list.push_back({{0, 0}, health_bar[health_]});
+    draw_list_.Push({0, 0}, health_bar[health_], DrawLayer::HUD);
     for (int i = 0; i < pearl_num_; ++i) {
-        draw_list.push_back({{((MAP_WIDTH / 2) + 1 + i * 3) * TILE_SIZE, 0}, pearl_inv_tile});
+        draw_list_.Push({((MAP_WIDTH / 2) + 1 + i * 3) * TILE_SIZE, 0}, pearl_inv_tile, DrawLayer::HUD);
     }
     if (state_ == GameState::WIN) {
-        draw_list.push_back({{0, 0}, win_img});
+        draw_list_.Push({0, 0}, win_img, DrawLayer::SCREEN);
     } else if (state_ == GameState::OVER) {
-        draw_list.push_back({{0, 0}, gameover_img});
+        draw_list_.Push({0, 0}, gameover_img, DrawLayer::SCREEN);
     } else if (idle_) {
-        draw_list.push_back({{0, 0}, rules_img});
+        draw_list_.Push({0, 0}, rules_img, DrawLayer::SCREEN);
     }
-    return draw_list;
+    return draw_list_;
 }
\ No newline at end of file
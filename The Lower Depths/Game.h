@@ -2,21 +2,32 @@
 #define MAIN_GAME_H
 
 #include "Image.h"
+#include "Bundle.h"
+#include "Room.h"
+#include "RoomLoader.h"
+#include "Collision.h"
+#include "FlowField.h"
+#include "Entities.h"
+#include "Lab.h"
+#include "SpatialGrid.h"
+#include "DrawCommands.h"
 #include "structs.hpp"
+#include "LruCache.hpp"
 
 #include<vector>
-#include<list>
 #include<string>
 #include<tuple>
 #include<map>
+#include<memory>
 
-constexpr int TILE_SIZE = 16;
-constexpr int MAP_WIDTH = 31, MAP_HEIGHT = 20;
 constexpr int ROOM_OFFSET = 3;
 constexpr int ROOM_Y_CENTER = ROOM_OFFSET + (MAP_HEIGHT - ROOM_OFFSET) / 2;
 constexpr int ROOM_X_CENTER = MAP_WIDTH / 2;
-constexpr int HOLE_MAP_TILE = 774, GUARD_MAP_TILE = 780;
-constexpr int LAB_SIZE = 8;
+constexpr Pixel BG_COLOR{41, 60, 66, 255};
+static_assert(TILE_SIZE == ATLAS_TILE_SIZE);
+constexpr size_t TILE_CACHE_BUDGET = 256 * TILE_SIZE * TILE_SIZE * sizeof(Pixel);
+constexpr size_t ROOM_CACHE_BUDGET = 64 * sizeof(RoomData);  // by type: more than a lab uses
+constexpr size_t BACKGROUND_CACHE_BUDGET = 8 * MAP_WIDTH * TILE_SIZE * MAP_HEIGHT * TILE_SIZE * sizeof(Pixel);
 
 enum class GameState {NONE, PLAY, OVER, WIN};
 enum class RoomState {NORMAL, FADEOUT, FADEIN};
@@ -27,33 +38,56 @@ public:
     void LabInit();
     void RoomInit();
     void RoomChangeCheck();
-    void RoomDraw();
+    PreparedRoom PrepareRoom(char type);
+    void PrefetchNeighbours();
+    Image ComposeBackground(const RoomData &room);
     void RoomEquip();
+    std::shared_ptr<const RoomData> LoadRoom(char type) const;
     void RoomFindPos();
     void ActivatePearl();
 
     void Move(Direction dir);
     void MoveGuards();
 
-    void UpdTime(double current_time);
+    // advances the frame clock to current_time and returns how many simulation ticks
+    // are due; after a stall the backlog beyond max_ticks_per_frame_ is dropped
+    int UpdTime(double current_time);
+    // starts one fixed tick: time moves by TICK, positions are kept for interpolation
+    void BeginTick();
+    constexpr static double TICK = 1.0 / 120;
 
-    char RoomType() const { return lab[cur_room_.y][cur_room_.x]; }
+    char RoomType() const { return LabCell(cur_room_); }
+    char LabCell(Point<int> room) const;
     double RoomFade() const;
 
     GameState State() const { return state_; }
 
     std::string Path() const {return path_; }
 
-    std::list<std::pair<Point<int>, const Image &>> DrawList();
+    // records this frame's draw commands, back to front; the buffer is reused every frame
+    const DrawCommands &DrawList();
+    // DrawList() and the fade, copied into frame; reuses its storage
+    void Snapshot(FrameSnapshot &frame);
 
     Point<int> PlayerPos() const {return player_pos_;}
 
+    // tile N of the atlas; without a bundle it is decoded on first use and kept in an LRU cache
+    std::shared_ptr<const Image> Tile(int n);
+    void SetTileCacheBudget(size_t bytes) { tile_cache_.SetBudget(bytes); }
+    CacheStats TileCacheStats() const { return tile_cache_.Stats(); }
+    void SetBackgroundCacheBudget(size_t bytes) { backgrounds_.SetBudget(bytes); }
+    CacheStats BackgroundCacheStats() const { return backgrounds_.Stats(); }
+
 private:
+    AssetBundle bundle_;  // asset images are views into it, so it goes first (destroyed last)
     GameState state_ = GameState::NONE;
     Image gameover_img, win_img, rules_img;
     Point<int> player_pos_{ROOM_X_CENTER * TILE_SIZE, ROOM_Y_CENTER * TILE_SIZE - 20};
     Point<double> player_pos_real_;
-    std::array<Image, 864 + 1> tiles;
+    Point<double> player_pos_prev_;  // at the start of the tick
+    Image tile_atlas_;
+    std::array<Image, ATLAS_TILE_COUNT> tiles;  // views into tile_atlas_, only with a bundle
+    LruCache<int, Image> tile_cache_{TILE_CACHE_BUDGET};  // decoded PNG tiles, only without one
     std::array<std::array<Image, 3>, 4> player_sprite;
     std::array<std::array<Image, 3>, 4> guard_sprite;
     std::array<Image, 9> hole_tile;
@@ -61,10 +95,15 @@ private:
     std::array<Image, 10> free_pearl_tile;
     std::array<Image, 5> lightning_effect;
     Image pearl_inv_tile;
-    Image background_{MAP_WIDTH * TILE_SIZE, MAP_HEIGHT * TILE_SIZE};
+    std::shared_ptr<const Image> background_;
+    LruCache<char, Image> backgrounds_{BACKGROUND_CACHE_BUDGET};  // composited, by RoomType()
+    std::shared_ptr<const RoomData> room_;
+    LruCache<char, RoomData> rooms_{ROOM_CACHE_BUDGET};  // by RoomType()
 
     Direction player_dir_ = Direction::DOWN;
-    double time_ = 0;
+    double time_ = 0;        // simulation time, whole ticks
+    double frame_time_ = 0;  // of the last UpdTime()
+    double tick_lag_ = 0;    // frame time not yet simulated, < TICK after UpdTime()
     double mean_delta_ = 0;
     double last_coral_hit_ = -coral_cd_ - 1;
     double last_pearl_activated_ = -pearl_cd_ - 1;
@@ -76,30 +115,51 @@ private:
     std::array<double, 4> last_player_move_{};
     uint64_t counter_ = 0;
 
-    std::vector<Point<int>> holes{};
-    std::map<int, std::vector<std::pair<Point<int>, bool>>> pearls;
-    std::vector<std::tuple<Point<int>, Direction, Point<double>>> guards{};
+    Entities holes_;   // phase: the wave rate of the animation
+    Entities guards_;
+    std::map<int64_t, Entities> pearls_by_room_;  // by CurRoomMap(): taken pearls stay taken
+    Entities *pearls_ = nullptr;                  // the current room's
+    SpatialGrid guard_grid_, pearl_grid_;         // over guards_ and *pearls_
 
     int health_ = 5;
     int pearl_num_ = 0;
     bool idle_ = true;
 
     constexpr static double player_speed_ = 90.0, guard_speed_ = 30.0;
+    constexpr static HitBox player_box_{0, 16, 19, 41};  // the feet and legs of the sprite
+    constexpr static HitBox guard_box_{2, 28, 17, 41};   // the feet, narrower than a cell
+    constexpr static uint8_t guard_blocking_ = CELL_WALL | CELL_EXIT;
+    constexpr static int guard_contact_ = 4;  // px between a guard and the player that catches them
+    // px from the player to any pearl their hitbox can touch within a tick
+    constexpr static int pearl_reach_ = 4 * TILE_SIZE;
     constexpr static double fade_semi_time_ = 0.3;
     constexpr static double coral_cd_ = 1.5;
     constexpr static int max_health_ = 8;
     constexpr static double pearl_cd_ = 3;
+    constexpr static int max_ticks_per_frame_ = 12;
     constexpr static int max_pearls_ = 5;
 
     Point<int> cur_room_{};
     Point<int> new_room_{};
 
+    DrawCommands draw_list_;
+
     std::array<char[MAP_WIDTH + 1], MAP_HEIGHT> objects;
-    std::array<char[LAB_SIZE + 1], LAB_SIZE> lab;
-    int CurRoomMap() {return cur_room_.y  * LAB_SIZE + cur_room_.x; }
+    CellGrid cells_{};  // CellMask of objects, built by RoomEquip
+    FlowField guard_flow_;  // towards the player's cell, rebuilt when that changes
+    Lab lab_;
+    int64_t CurRoomMap() const { return lab_.Index(cur_room_); }
+    // the way from `from` towards the player along one axis
+    Direction ChaseDir(Point<double> from, bool horizontal) const;
+    // where to draw an entity between its last two ticks
+    Point<int> Interpolate(Point<double> prev, Point<double> cur) const;
 
 
     std::string path_;
+
+    // prepares the next room and the neighbours off the main thread; it uses the members
+    // above, so it goes last (constructed last, destroyed first)
+    RoomLoader room_loader_{[this](char type) { return PrepareRoom(type); }};
 };
 
 #endif 
\ No newline at end of file
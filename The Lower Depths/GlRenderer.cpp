@@ -0,0 +1,214 @@
+#include "GlRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+static const char *VERTEX_SHADER = R"(#version 330 core
+layout(location = 0) in vec2 pos;
+layout(location = 1) in vec2 uv;
+layout(location = 2) in vec4 color;
+uniform vec2 screen;
+out vec2 frag_uv;
+out vec4 frag_color;
+void main() {
+    gl_Position = vec4(pos.x / screen.x * 2.0 - 1.0, 1.0 - pos.y / screen.y * 2.0, 0.0, 1.0);
+    frag_uv = uv;
+    frag_color = color;
+}
+)";
+
+static const char *FRAGMENT_SHADER = R"(#version 330 core
+in vec2 frag_uv;
+in vec4 frag_color;
+uniform sampler2D tex;
+out vec4 out_color;
+void main() {
+    out_color = texture(tex, frag_uv) * frag_color;
+}
+)";
+
+static GLuint CompileShader(GLenum type, const char *source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << "Shader compilation failed: " << log << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static void SetTextureParams() {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+bool GlRenderer::Init() {
+    if (!GLAD_GL_VERSION_3_3) {
+        return false;
+    }
+    GLuint vs = CompileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+    GLuint fs = CompileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+    if (!vs || !fs) {
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return false;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        std::cerr << "Shader program linking failed" << std::endl;
+        glDeleteProgram(program);
+        return false;
+    }
+    program_ = program;
+    screen_loc_ = glGetUniformLocation(program_, "screen");
+
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, x)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, u)));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, color)));
+    for (GLuint i = 0; i < 3; ++i) {
+        glEnableVertexAttribArray(i);
+    }
+    glBindVertexArray(0);
+
+    glGenTextures(1, &atlas_);
+    glBindTexture(GL_TEXTURE_2D, atlas_);
+    SetTextureParams();
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlas_size_, atlas_size_, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    static Image white(1, 1, Pixel{255, 255, 255, 255});
+    PackIntoAtlas(white, white_);
+    // sample the middle of the texel, not its edge
+    white_.u0 = white_.u1 = (white_.u0 + white_.u1) / 2;
+    white_.v0 = white_.v1 = (white_.v0 + white_.v1) / 2;
+    return true;
+}
+
+GLuint GlRenderer::Upload(const Image &img) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    SetTextureParams();
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, img.stride());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, img.width(), img.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, img.data());
+    stats_.texture_bytes += img.width() * img.height() * sizeof(Pixel);
+    return texture;
+}
+
+// shelf packing: images fill a row left to right, the row is as tall as its tallest image
+bool GlRenderer::PackIntoAtlas(const Image &img, Region &region) {
+    if (img.width() > max_packed_size_ || img.height() > max_packed_size_) {
+        return false;
+    }
+    if (shelf_x_ + img.width() > atlas_size_) {
+        shelf_x_ = 0;
+        shelf_y_ += shelf_height_;
+        shelf_height_ = 0;
+    }
+    if (shelf_y_ + img.height() > atlas_size_) {
+        return false;
+    }
+    glBindTexture(GL_TEXTURE_2D, atlas_);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, img.stride());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, shelf_x_, shelf_y_, img.width(), img.height(),
+                    GL_RGBA, GL_UNSIGNED_BYTE, img.data());
+    stats_.texture_bytes += img.width() * img.height() * sizeof(Pixel);
+    const GLfloat scale = 1.0f / atlas_size_;
+    region = {atlas_, shelf_x_ * scale, shelf_y_ * scale,
+              (shelf_x_ + img.width()) * scale, (shelf_y_ + img.height()) * scale};
+    shelf_x_ += img.width();
+    shelf_height_ = std::max(shelf_height_, img.height());
+    return true;
+}
+
+const GlRenderer::Region &GlRenderer::Find(const Image &img) {
+    if (&img == background_.get()) {
+        return background_region_;
+    }
+    auto it = regions_.find(&img);
+    if (it == regions_.end()) {
+        Region region;
+        if (!PackIntoAtlas(img, region)) {
+            region = {Upload(img), 0, 0, 1, 1};
+        }
+        it = regions_.emplace(&img, region).first;
+    }
+    return it->second;
+}
+
+void GlRenderer::PushQuad(Point<int> pos, int width, int height, const Region &region, BlendMode mode, Pixel color) {
+    if (batches_.empty() || batches_.back().texture != region.texture || batches_.back().mode != mode) {
+        batches_.push_back({region.texture, mode, static_cast<GLint>(vertices_.size()), 0});
+    }
+    GLfloat x0 = pos.x, y0 = pos.y, x1 = pos.x + width, y1 = pos.y + height;
+    Vertex tl{x0, y0, region.u0, region.v0, {color.r, color.g, color.b, color.a}};
+    Vertex tr{x1, y0, region.u1, region.v0, {color.r, color.g, color.b, color.a}};
+    Vertex bl{x0, y1, region.u0, region.v1, {color.r, color.g, color.b, color.a}};
+    Vertex br{x1, y1, region.u1, region.v1, {color.r, color.g, color.b, color.a}};
+    vertices_.insert(vertices_.end(), {tl, bl, tr, tr, bl, br});
+    batches_.back().count += 6;
+}
+
+void GlRenderer::Render(const FrameSnapshot &frame) {
+    if (frame.background != background_) {
+        glDeleteTextures(1, &background_region_.texture);
+        background_region_ = {Upload(*frame.background), 0, 0, 1, 1};
+        background_ = frame.background;
+    }
+
+    vertices_.clear();
+    batches_.clear();
+    constexpr Pixel white{255, 255, 255, 255};
+    for (const DrawCommand &cmd : frame.commands) {
+        PushQuad(cmd.pos, cmd.image->width(), cmd.image->height(), Find(*cmd.image), cmd.mode, white);
+    }
+    double fade = std::min(frame.fade, 1.0);
+    if (fade > 0) {
+        Pixel color = BG_COLOR;
+        color.a = static_cast<uint8_t>(std::lround(fade * 255));
+        PushQuad({0, 0}, MAP_WIDTH * TILE_SIZE, MAP_HEIGHT * TILE_SIZE, white_, BlendMode::ALPHA, color);
+    }
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    glUseProgram(program_);
+    glUniform2f(screen_loc_, MAP_WIDTH * TILE_SIZE, MAP_HEIGHT * TILE_SIZE);
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    GLsizeiptr bytes = vertices_.size() * sizeof(Vertex);
+    glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);  // orphan last frame's batch
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices_.data());
+    for (const Batch &batch : batches_) {
+        if (batch.mode == BlendMode::EFFECT) {
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
+        } else {
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        glBindTexture(GL_TEXTURE_2D, batch.texture);
+        glDrawArrays(GL_TRIANGLES, batch.first, batch.count);
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    ++stats_.frames;
+    stats_.vertex_bytes += bytes;
+    stats_.draw_calls += batches_.size();
+}
@@ -0,0 +1,84 @@
+#ifndef MAIN_GL_RENDERER_H
+#define MAIN_GL_RENDERER_H
+
+#include "Image.h"
+#include "Game.h"
+#include "DrawCommands.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct GlRenderStats {
+    uint64_t frames = 0;
+    uint64_t texture_bytes = 0;  // pixels uploaded with glTexImage2D / glTexSubImage2D
+    uint64_t vertex_bytes = 0;   // per-frame quad batches
+    uint64_t draw_calls = 0;
+};
+
+// Draws a frame's DrawCommands as textured quads from one vertex buffer. Every image
+// is uploaded once: small sprites are shelf-packed into a shared atlas texture, large
+// ones (screens, effects) get a texture each, and the room background is re-uploaded
+// only when the room changes. Consecutive quads with the same texture and blend mode
+// go out in one draw call. Needs a GL 3.3 context; without one Init() fails and the
+// caller keeps drawing with glDrawPixels (SoftwareRenderer covers the no-GL case).
+class GlRenderer {
+public:
+    // GL objects are not deleted: they live as long as the context, which main() tears
+    // down with glfwTerminate() while the renderer is still in scope
+    GlRenderer() = default;
+    GlRenderer(const GlRenderer &) = delete;
+    GlRenderer &operator =(const GlRenderer &) = delete;
+
+    // compiles the shaders and creates the buffers; the context must be current
+    bool Init();
+    // the frame's commands plus the room fade overlay, into the current framebuffer
+    void Render(const FrameSnapshot &frame);
+    const GlRenderStats &Stats() const { return stats_; }
+
+private:
+    struct Vertex {
+        GLfloat x, y;  // game pixels, top-left origin
+        GLfloat u, v;
+        uint8_t color[4];
+    };
+    struct Region {  // where an image lives on the GPU
+        GLuint texture;
+        GLfloat u0, v0, u1, v1;
+    };
+    struct Batch {
+        GLuint texture;
+        BlendMode mode;
+        GLint first;
+        GLsizei count;
+    };
+
+    const Region &Find(const Image &img);
+    GLuint Upload(const Image &img);
+    bool PackIntoAtlas(const Image &img, Region &region);
+    void PushQuad(Point<int> pos, int width, int height, const Region &region, BlendMode mode, Pixel color);
+
+    GLuint program_ = 0, vao_ = 0, vbo_ = 0;
+    GLint screen_loc_ = -1;
+
+    GLuint atlas_ = 0;
+    int shelf_x_ = 0, shelf_y_ = 0, shelf_height_ = 0;
+    Region white_{};  // one opaque texel of the atlas, for solid quads
+
+    // images are owned by the Game and outlive the renderer's use of them
+    std::unordered_map<const Image *, Region> regions_;
+    Region background_region_{};
+    std::shared_ptr<const Image> background_;  // held, so its address can't be reused
+
+    std::vector<Vertex> vertices_;
+    std::vector<Batch> batches_;
+    GlRenderStats stats_;
+
+    constexpr static int atlas_size_ = 1024;
+    constexpr static int max_packed_size_ = 256;
+};
+
+#endif  // MAIN_GL_RENDERER_H
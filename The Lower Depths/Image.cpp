@@ -1,4 +1,5 @@
 #include "Image.h"
+#include "Blend.h"
 
 #include <iostream>
 #include <cstring>
@@ -21,6 +22,7 @@ Image::Image(const std::string &a_path) {
     int channels_in_file;
     if (data_ = (Pixel *)stbi_load(a_path.c_str(), &width_, &height_, &channels_in_file, 4)) {
         size_ = width_ * height_ * 4;
+        stride_ = width_;
         // std::cout << "Successfully loaded " << width_ << "x" << height_ 
         //           << "(originally " << channels_in_file << " channels)"
         //           << " image from " << a_path << std::endl;
@@ -29,12 +31,13 @@ Image::Image(const std::string &a_path) {
     }
 }
 
-Image::Image(int a_width, int a_height, Pixel fillColor) : width_(a_width), height_(a_height) {
+Image::Image(int a_width, int a_height, Pixel fillColor) : width_(a_width), height_(a_height),
+                                                           stride_(a_width) {
     // std::cout << "hand-made constructor!" << std::endl;
     data_ = new Pixel[width_ * height_]{};
     if (data_) {
         size_ = width_ * height_ * 4;
-        self_allocated_ = true;
+        storage_ = Storage::HEAP;
         // std::cout << "Successfully allocated " << width_ << "x" << height_ << std::endl;
     } else {
         std::cerr << "Fail to allocate " << width_ * height_ * sizeof(Pixel)
@@ -48,30 +51,55 @@ Image::Image(int a_width, int a_height, Pixel fillColor) : width_(a_width), heig
 Image::~Image() {
     // std::cout << "Destruct!" << std::endl;
     if (size_ > 0) {
-        if (self_allocated_) {
+        if (storage_ == Storage::HEAP) {
             delete[] data_;
         }
-        else {
+        else if (storage_ == Storage::STB) {
             stbi_image_free(data_);
         }
     }
 }
 
-Image::Image(const Image &other) : width_(other.width_), height_(other.height_),
-                                   size_(other.size_), self_allocated_(other.self_allocated_) {
+Image::Image(const Image &other) : width_(other.width_), height_(other.height_), stride_(other.width_),
+                                   size_(other.size_), storage_(Storage::HEAP) {
     std::cout << "COPY constructor!" << std::endl;
     if (other.data_) {
         data_ = new Pixel[width_ * height_];
-        std::memcpy(data_, other.data_, size_);
+        PutTile(0, 0, other);
     }
 }
 
+Image Image::View(Pixel *a_data, int a_width, int a_height, int a_stride) {
+    Image view;
+    view.width_ = a_width;
+    view.height_ = a_height;
+    view.stride_ = a_stride > 0 ? a_stride : a_width;
+    view.data_ = a_data;
+    view.size_ = a_width * a_height * 4;
+    view.storage_ = Storage::VIEW;
+    return view;
+}
+
+Image Image::SubImage(int x, int y, int a_width, int a_height) const {
+    if (!CheckPixel(x, y) || !CheckPixel(x + a_width - 1, y + a_height - 1)) {
+        std::cerr << "Sub-image " << a_width << "x" << a_height << " at (" << x << ", " << y
+                  << ") is out of " << width_ << "x" << height_ << std::endl;
+        return Image();
+    }
+    return View(&data_[stride_ * y + x], a_width, a_height, stride_);
+}
+
+Image::Image(Image &&other) noexcept {
+    Swap(other);
+}
+
 void Image::Swap(Image &other) {
     // std::cout << "Swap!" << std::endl;
     std::swap(width_, other.width_);
     std::swap(height_, other.height_);
+    std::swap(stride_, other.stride_);
     std::swap(size_, other.size_);
-    std::swap(self_allocated_, other.self_allocated_);
+    std::swap(storage_, other.storage_);
     std::swap(data_, other.data_);
 }
 
@@ -82,13 +110,15 @@ const Image &Image::operator =(Image other) {
 }
 
 void Image::FillImage(Pixel fillColor) {
-    for (int i = 0; i < width_ * height_; ++i) {
-        data_[i] = fillColor;
+    for (int i = 0; i < height_; ++i) {
+        for (int j = 0; j < width_; ++j) {
+            data_[i * stride_ + j] = fillColor;
+        }
     }
 }
 
 void Image::Save(const char *path) {
-    if (stbi_write_png(path, width_, height_, 4, data_, width_ * 4)) {
+    if (stbi_write_png(path, width_, height_, 4, data_, stride_ * 4)) {
         std::cout << width_ << "x" << height_ << "image (png, RGBA) written to "
                   << path << std::endl;
     } else {
@@ -107,7 +137,7 @@ Pixel Image::GetPixel(int x, int y) const {
         std::cerr << "(x, y) == (" << x << ", " << y << ")" << std::endl;
         exit(1);
     }
-    return data_[width_ * y + x];
+    return data_[stride_ * y + x];
 }
 
 void Image::PutPixel(int x, int y, const Pixel &pix) {
@@ -116,23 +146,19 @@ void Image::PutPixel(int x, int y, const Pixel &pix) {
         std::cerr << "(x, y) == (" << x << ", " << y << ")" << std::endl;
         return;
     }
-    data_[width_ * y + x] = pix;
+    data_[stride_ * y + x] = pix;
 }
 
 void Image::PutTile(int x, int y, const Image &tile) {
     for (int i = 0; i < tile.height_; ++i) {
-        std::memcpy(&data_[(y + i) * width_ + x], &tile.data_[tile.width_ * i],
+        std::memcpy(&data_[(y + i) * stride_ + x], &tile.data_[tile.stride_ * i],
                     tile.width_ * sizeof(Pixel));
     }
 }
 
 void Image::PutTileOver(int x, int y, const Image &tile) {
-    for (int i = 0; i < tile.height_; ++i) {
-        for (int j = 0; j < tile.width_; ++j) {
-            if (tile.data_[i * tile.width_ + j].a) {  // no semitransparent blending on CPU
-                data_[(y + i) * width_ + x + j] = tile.data_[i * tile.width_ + j];
-            }
-        }
+    for (int i = 0; i < tile.height_; ++i) {  // no semitransparent blending on CPU
+        CopyRowMasked(data_ + (y + i) * stride_ + x, tile.data_ + i * tile.stride_, tile.width_);
     }
 }
 
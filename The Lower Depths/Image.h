@@ -15,12 +15,20 @@ std::ostream& operator<<(std::ostream& os, const Pixel& p);
 
 class Image {
 public:
+    // who frees data_: stb_image, operator new[] or nobody (a view into foreign memory)
+    enum class Storage : uint8_t {STB, HEAP, VIEW};
+
     // 32-bit RGBA
     Image(){}
     explicit Image(const std::string &a_path);
     Image(int a_width, int a_height, Pixel fillColor = {});
     ~Image();
     Image(const Image &other);
+    Image(Image &&other) noexcept;
+    // non-owning image over a_data, which must outlive it; rows are a_stride pixels apart
+    static Image View(Pixel *a_data, int a_width, int a_height, int a_stride = 0);
+    // non-owning view of a sub-rectangle, shares this image's rows
+    Image SubImage(int x, int y, int a_width, int a_height) const;
     void Swap(Image &other);
     const Image &operator =(Image other);
     
@@ -35,15 +43,18 @@ public:
 
     int width() const { return width_; }
     int height() const { return height_; }
+    int stride() const { return stride_; }  // in pixels
     size_t size() const { return size_; }
     Pixel *data() const { return data_; }
+    bool IsView() const { return storage_ == Storage::VIEW; }
 
 private:
     int width_ = -1;
     int height_ = -1;
+    int stride_ = 0;
     Pixel *data_ = nullptr;
     size_t size_{};
-    bool self_allocated_ = false;
+    Storage storage_ = Storage::STB;
 };
 
 #endif  // MAIN_IMAGE_H
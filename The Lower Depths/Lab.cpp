@@ -0,0 +1,65 @@
+#include "Lab.h"
+
+#include <algorithm>
+#include <iostream>
+
+bool Lab::Open(const std::string &path) {
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    chunks_.Clear();
+    rows_.clear();
+    width_ = 0;
+    start_ = {};
+    file_.close();
+    file_.clear();
+    file_.open(path, std::ios::binary);
+    if (!file_) {
+        std::cerr << "Failed to open the lab " << path << std::endl;
+        return false;
+    }
+    // one line at a time: only the row index stays
+    std::string line;
+    for (std::streamoff offset = 0; std::getline(file_, line); offset = file_.tellg()) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t start = line.find('@');
+        if (start != std::string::npos) {
+            start_ = {static_cast<int>(start), Height()};
+        }
+        rows_.push_back({offset, static_cast<int>(line.size())});
+        width_ = std::max(width_, static_cast<int>(line.size()));
+    }
+    file_.clear();  // getline stopped at the end of the file
+    return true;
+}
+
+char Lab::Cell(Point<int> room) const {
+    if (room.x < 0 || room.y < 0 || room.x >= Width() || room.y >= Height()) {
+        return '-';
+    }
+    int chunk_x = room.x / LAB_CHUNK_SIZE, chunk_y = room.y / LAB_CHUNK_SIZE;
+    auto chunk = chunks_.GetOrLoad(uint64_t(chunk_y) << 32 | uint32_t(chunk_x),
+                                   [&] { return LoadChunk(chunk_x, chunk_y); },
+                                   [](const Chunk &) { return sizeof(Chunk); });
+    return chunk->cells[room.y % LAB_CHUNK_SIZE * LAB_CHUNK_SIZE + room.x % LAB_CHUNK_SIZE];
+}
+
+std::shared_ptr<const Lab::Chunk> Lab::LoadChunk(int chunk_x, int chunk_y) const {
+    auto chunk = std::make_shared<Chunk>();
+    chunk->cells.fill('-');  // past the end of a short row, or of the lab
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    int x0 = chunk_x * LAB_CHUNK_SIZE, y0 = chunk_y * LAB_CHUNK_SIZE;
+    for (int y = y0; y < std::min(y0 + LAB_CHUNK_SIZE, Height()); ++y) {
+        int count = std::min(rows_[y].length - x0, LAB_CHUNK_SIZE);
+        if (count <= 0) {
+            continue;
+        }
+        file_.seekg(rows_[y].offset + x0);
+        file_.read(chunk->cells.data() + (y - y0) * LAB_CHUNK_SIZE, count);
+    }
+    if (!file_) {
+        std::cerr << "Failed to read the lab around room " << x0 << ", " << y0 << std::endl;
+        file_.clear();
+    }
+    return chunk;
+}
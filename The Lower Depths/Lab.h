@@ -0,0 +1,54 @@
+#ifndef MAIN_LAB_H
+#define MAIN_LAB_H
+
+#include "LruCache.hpp"
+#include "structs.hpp"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+constexpr int LAB_CHUNK_SIZE = 16;  // rooms along a side of a chunk
+constexpr size_t LAB_CHUNK_BUDGET = 64 * LAB_CHUNK_SIZE * LAB_CHUNK_SIZE;  // bytes of resident chunks
+
+// The labyrinth (Lab.mashgraph): a room type per character, '-' where there is no room,
+// '@' for the first room; any number of rows of any length. Open() keeps only where each
+// row starts in the file. Cells are read from disk a LAB_CHUNK_SIZE square at a time on
+// first use and kept in an LRU cache, so only the chunks around the rooms visited lately
+// stay in memory, however large the lab.
+class Lab {
+public:
+    bool Open(const std::string &path);
+
+    int Width() const { return width_; }
+    int Height() const { return static_cast<int>(rows_.size()); }
+    Point<int> Start() const { return start_; }
+    // the type of the room; '-' outside the lab
+    char Cell(Point<int> room) const;
+    // a number of its own for every room of the lab
+    int64_t Index(Point<int> room) const { return int64_t(room.y) * width_ + room.x; }
+    CacheStats Stats() const { return chunks_.Stats(); }
+
+private:
+    struct Chunk {
+        std::array<char, LAB_CHUNK_SIZE * LAB_CHUNK_SIZE> cells;  // row by row
+    };
+    struct Row {
+        std::streamoff offset;
+        int length;
+    };
+    std::shared_ptr<const Chunk> LoadChunk(int chunk_x, int chunk_y) const;
+
+    std::vector<Row> rows_;
+    int width_ = 0;
+    Point<int> start_{};
+    mutable std::mutex file_mutex_;  // chunks may load on more than one thread
+    mutable std::ifstream file_;
+    mutable LruCache<uint64_t, Chunk> chunks_{LAB_CHUNK_BUDGET};  // by y << 32 | x, in chunks
+};
+
+#endif  // MAIN_LAB_H
@@ -0,0 +1,135 @@
+#ifndef LRU_CACHE_HPP
+#define LRU_CACHE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t bytes = 0;
+    size_t entries = 0;
+};
+
+// Thread-safe least-recently-used cache with a memory budget in bytes.
+// Values are handed out as shared_ptr, so evicting an entry never invalidates
+// a value someone is still using.
+template<class Key, class Value>
+class LruCache {
+public:
+    using ValuePtr = std::shared_ptr<const Value>;
+
+    explicit LruCache(size_t budget) : budget_(budget) {}
+
+    // nullptr on a miss
+    ValuePtr Get(const Key &key);
+    // inserts (or replaces) and evicts the least recently used entries over budget;
+    // the newest entry always stays, even if it alone exceeds the budget
+    void Put(const Key &key, ValuePtr value, size_t bytes);
+    // Get, and on a miss Put(key, load(), bytes(value)). load runs without the lock held.
+    template<class Load, class Bytes>
+    ValuePtr GetOrLoad(const Key &key, Load load, Bytes bytes);
+
+    void SetBudget(size_t budget);
+    void Clear();
+    CacheStats Stats() const;
+
+private:
+    struct Entry {
+        ValuePtr value;
+        size_t bytes;
+        typename std::list<Key>::iterator lru_pos;
+    };
+    void EvictOverBudget();
+
+    mutable std::mutex mutex_;
+    std::list<Key> lru_;  // front is the most recently used
+    std::unordered_map<Key, Entry> entries_;
+    size_t budget_;
+    CacheStats stats_;
+};
+
+template<class Key, class Value>
+typename LruCache<Key, Value>::ValuePtr LruCache<Key, Value>::Get(const Key &key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.hits;
+    lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+    return it->second.value;
+}
+
+template<class Key, class Value>
+void LruCache<Key, Value>::Put(const Key &key, ValuePtr value, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        stats_.bytes -= it->second.bytes;
+        it->second.value = std::move(value);
+        it->second.bytes = bytes;
+        lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+    } else {
+        lru_.push_front(key);
+        entries_.emplace(key, Entry{std::move(value), bytes, lru_.begin()});
+    }
+    stats_.bytes += bytes;
+    EvictOverBudget();
+}
+
+template<class Key, class Value>
+template<class Load, class Bytes>
+typename LruCache<Key, Value>::ValuePtr LruCache<Key, Value>::GetOrLoad(const Key &key, Load load, Bytes bytes) {
+    if (ValuePtr value = Get(key)) {
+        return value;
+    }
+    ValuePtr value = load();
+    if (value) {
+        Put(key, value, bytes(*value));
+    }
+    return value;
+}
+
+template<class Key, class Value>
+void LruCache<Key, Value>::SetBudget(size_t budget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budget;
+    EvictOverBudget();
+}
+
+template<class Key, class Value>
+void LruCache<Key, Value>::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    stats_.bytes = 0;
+}
+
+template<class Key, class Value>
+CacheStats LruCache<Key, Value>::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CacheStats stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+template<class Key, class Value>
+void LruCache<Key, Value>::EvictOverBudget() {
+    while (stats_.bytes > budget_ && entries_.size() > 1) {
+        auto it = entries_.find(lru_.back());
+        stats_.bytes -= it->second.bytes;
+        entries_.erase(it);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+}
+
+#endif
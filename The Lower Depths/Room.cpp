@@ -0,0 +1,243 @@
+#include "Room.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ROOM_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+static_assert(MAP_WIDTH < 32, "a row of objects must fit the bits of a uint32_t");
+
+// columns of one row of objects holding each kind of spawn, bit x for column x
+struct RowSpawns {
+    uint32_t holes, guards, pearls;
+};
+
+RowSpawns ScanRow(const char (&row)[MAP_WIDTH + 1]) {
+#ifdef ROOM_SSE2
+    // the row and its terminator are 32 bytes: two vectors, one byte compare per kind
+    static_assert(MAP_WIDTH + 1 == 32);
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + 16));
+    auto columns = [&](char object) {
+        __m128i v = _mm_set1_epi8(object);
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, v))) |
+               static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, v))) << 16;
+    };
+    // a short line leaves stale bytes after its terminator; keep the columns before it
+    uint32_t end = columns('\0');
+    uint32_t line = (end & (~end + 1)) - 1;
+    return {columns('h') & line, columns('g') & line, columns('p') & line};
+#else
+    RowSpawns spawns{0, 0, 0};
+    for (int x = 0; x < MAP_WIDTH && row[x]; ++x) {
+        spawns.holes |= uint32_t(row[x] == 'h') << x;
+        spawns.guards |= uint32_t(row[x] == 'g') << x;
+        spawns.pearls |= uint32_t(row[x] == 'p') << x;
+    }
+    return spawns;
+#endif
+}
+
+int LowestColumn(uint32_t columns) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long x;
+    _BitScanForward(&x, columns);
+    return x;
+#else
+    return __builtin_ctz(columns);
+#endif
+}
+
+// left cells of the objects two cells wide: every other column of each run
+uint32_t PairStarts(uint32_t columns) {
+    uint32_t starts = 0;
+    while (columns) {
+        uint32_t first = columns & (~columns + 1);
+        starts |= first;
+        columns &= ~(first | first << 1);
+    }
+    return starts;
+}
+
+// one spawn point per set column, offset by shift pixels from the cell's corner
+void Emit(std::vector<Point<int>> &points, uint32_t columns, int row, int shift) {
+    for (; columns; columns &= columns - 1) {
+        points.push_back({LowestColumn(columns) * TILE_SIZE + shift, row * TILE_SIZE + shift});
+    }
+}
+
+uint16_t RoomCell(uint32_t tiled_gid) {
+    uint32_t index = tiled_gid & 0x1fffffff;
+    if (index > ROOM_TILE_INDEX) {
+        std::cerr << "Tile id " << index << " does not fit a room cell" << std::endl;
+        index = 0;
+    }
+    uint16_t cell = index;
+    if (tiled_gid & 0x80000000u) cell |= ROOM_TILE_FLIP_H;
+    if (tiled_gid & 0x40000000u) cell |= ROOM_TILE_FLIP_V;
+    if (tiled_gid & 0x20000000u) cell |= ROOM_TILE_FLIP_D;
+    return cell;
+}
+
+template<class T>
+void Append(std::vector<char> &buf, const T *data, size_t count) {
+    const char *bytes = reinterpret_cast<const char *>(data);
+    buf.insert(buf.end(), bytes, bytes + count * sizeof(T));
+}
+
+}  // namespace
+
+bool RoomData::ParseText(const std::string &rooms_dir, char type) {
+    std::ifstream fin_back(rooms_dir + type + "_back.csv");
+    std::ifstream fin_items(rooms_dir + type + "_items.csv");
+    std::ifstream fin_objects(rooms_dir + type + ".mashgraph");
+    if (!fin_back || !fin_items || !fin_objects) {
+        std::cerr << "Failed to open room " << type << " in " << rooms_dir << std::endl;
+        return false;
+    }
+    for (int i = 0; i < MAP_WIDTH * MAP_HEIGHT; ++i) {
+        uint32_t back_gid = 0, item_gid = 0;
+        fin_back >> back_gid;
+        fin_items >> item_gid;
+        back[i] = RoomCell(back_gid);
+        int item = item_gid & 0x1fffffff;
+        items[i] = (item > 0 && item != HOLE_MAP_TILE && item != GUARD_MAP_TILE) ? RoomCell(item_gid) : 0;
+    }
+    if (!fin_back || !fin_items) {
+        std::cerr << "Room " << type << " has less than " << MAP_WIDTH * MAP_HEIGHT << " tiles" << std::endl;
+        return false;
+    }
+
+    // one pass over the rows: holes are "hh", guards "g", pearls a 2x2 block of "p"
+    holes.clear();
+    guards.clear();
+    pearls.clear();
+    uint32_t pearl_tops = 0;  // columns where a pearl began on the row above
+    for (int i = 0; i < MAP_HEIGHT; ++i) {
+        fin_objects.getline(objects[i], MAP_WIDTH + 1);
+        RowSpawns spawns = ScanRow(objects[i]);
+        Emit(holes, PairStarts(spawns.holes), i, 0);
+        Emit(guards, spawns.guards, i, 0);
+        // under a pearl's top half is its bottom half, not a new pearl
+        pearl_tops = PairStarts(spawns.pearls) & ~pearl_tops;
+        Emit(pearls, pearl_tops, i, -8);
+    }
+    return true;
+}
+
+bool RoomData::Load(const std::string &path) {
+    std::ifstream fin(path, std::ios::binary | std::ios::ate);
+    if (!fin) {
+        return false;
+    }
+    std::vector<char> buf(fin.tellg());
+    fin.seekg(0);
+    fin.read(buf.data(), buf.size());
+
+    RoomHeader header{};
+    constexpr size_t cells = MAP_WIDTH * MAP_HEIGHT;
+    constexpr size_t fixed = sizeof(RoomHeader) + 2 * cells * sizeof(uint16_t) + cells;
+    if (!fin || buf.size() < sizeof(RoomHeader)) {
+        std::cerr << "Failed to read room " << path << std::endl;
+        return false;
+    }
+    std::memcpy(&header, buf.data(), sizeof(header));
+    if (std::memcmp(header.magic, ROOM_MAGIC, sizeof(ROOM_MAGIC)) != 0 || header.version != ROOM_VERSION ||
+        header.width != MAP_WIDTH || header.height != MAP_HEIGHT) {
+        std::cerr << "Stale or foreign room blob " << path << ", rebuild it with the packer" << std::endl;
+        return false;
+    }
+    size_t points = size_t(header.hole_count) + header.guard_count + header.pearl_count;
+    if (buf.size() != fixed + points * 2 * sizeof(int32_t)) {
+        std::cerr << "Truncated room blob " << path << std::endl;
+        return false;
+    }
+
+    const char *p = buf.data() + sizeof(RoomHeader);
+    std::memcpy(back.data(), p, cells * sizeof(uint16_t));
+    p += cells * sizeof(uint16_t);
+    std::memcpy(items.data(), p, cells * sizeof(uint16_t));
+    p += cells * sizeof(uint16_t);
+    for (int i = 0; i < MAP_HEIGHT; ++i, p += MAP_WIDTH) {
+        std::memcpy(objects[i], p, MAP_WIDTH);
+        objects[i][MAP_WIDTH] = '\0';
+    }
+    holes.resize(header.hole_count);
+    guards.resize(header.guard_count);
+    pearls.resize(header.pearl_count);
+    for (auto *list : {&holes, &guards, &pearls}) {
+        for (auto &point : *list) {
+            int32_t xy[2];
+            std::memcpy(xy, p, sizeof(xy));
+            p += sizeof(xy);
+            point = {xy[0], xy[1]};
+        }
+    }
+    return true;
+}
+
+bool RoomData::Save(const std::string &path) const {
+    RoomHeader header{};
+    std::memcpy(header.magic, ROOM_MAGIC, sizeof(ROOM_MAGIC));
+    header.version = ROOM_VERSION;
+    header.width = MAP_WIDTH;
+    header.height = MAP_HEIGHT;
+    header.hole_count = holes.size();
+    header.guard_count = guards.size();
+    header.pearl_count = pearls.size();
+
+    std::vector<char> buf;
+    Append(buf, &header, 1);
+    Append(buf, back.data(), back.size());
+    Append(buf, items.data(), items.size());
+    for (const auto &row : objects) {
+        Append(buf, row, MAP_WIDTH);
+    }
+    for (const auto *list : {&holes, &guards, &pearls}) {
+        for (const auto &point : *list) {
+            int32_t xy[2] = {point.x, point.y};
+            Append(buf, xy, 2);
+        }
+    }
+    std::ofstream fout(path, std::ios::binary);
+    fout.write(buf.data(), buf.size());
+    return static_cast<bool>(fout);
+}
+
+uint8_t CellMask(char object) {
+    switch (object) {
+        case '#': return CELL_WALL;
+        case 'c': return CELL_CORAL;
+        case 'h': return CELL_HOLE;
+        case 'x': return CELL_EXIT;
+        case 'p': return CELL_PEARL;
+        case 'Q': return CELL_GOAL;
+        default: return 0;
+    }
+}
+
+Image OrientTile(const Image &tile, uint16_t cell) {
+    // Tiled applies the diagonal flip (x/y swap) first, then the horizontal and vertical ones
+    Image res(tile.width(), tile.height());
+    int last = tile.width() - 1;
+    for (int y = 0; y < tile.height(); ++y) {
+        for (int x = 0; x < tile.width(); ++x) {
+            int sx = (cell & ROOM_TILE_FLIP_H) ? last - x : x;
+            int sy = (cell & ROOM_TILE_FLIP_V) ? last - y : y;
+            if (cell & ROOM_TILE_FLIP_D) {
+                std::swap(sx, sy);
+            }
+            res.PutPixel(x, y, tile.GetPixel(sx, sy));
+        }
+    }
+    return res;
+}
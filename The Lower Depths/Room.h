@@ -0,0 +1,67 @@
+#ifndef MAIN_ROOM_H
+#define MAIN_ROOM_H
+
+#include "Image.h"
+#include "structs.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr int TILE_SIZE = 16;
+constexpr int MAP_WIDTH = 31, MAP_HEIGHT = 20;
+constexpr int HOLE_MAP_TILE = 774, GUARD_MAP_TILE = 780;
+
+// Tiled stores flipped tiles as the tile id with flip flags in the top bits;
+// room cells keep the id in the low bits and the same three flags on top
+constexpr uint16_t ROOM_TILE_INDEX = 0x1fff;
+constexpr uint16_t ROOM_TILE_FLIP_H = 0x8000, ROOM_TILE_FLIP_V = 0x4000, ROOM_TILE_FLIP_D = 0x2000;
+constexpr uint16_t ROOM_TILE_FLIPS = ROOM_TILE_FLIP_H | ROOM_TILE_FLIP_V | ROOM_TILE_FLIP_D;
+
+// Collision bits of a cell of the objects grid, so a probe of several cells is an OR
+constexpr uint8_t CELL_WALL = 1 << 0;   // '#'
+constexpr uint8_t CELL_CORAL = 1 << 1;  // 'c'
+constexpr uint8_t CELL_HOLE = 1 << 2;   // 'h'
+constexpr uint8_t CELL_EXIT = 1 << 3;   // 'x'
+constexpr uint8_t CELL_PEARL = 1 << 4;  // 'p'
+constexpr uint8_t CELL_GOAL = 1 << 5;   // 'Q'
+uint8_t CellMask(char object);
+
+// Compiled room blob written by the packer next to the text sources (rooms/X.room).
+// Layout (native byte order):
+//   RoomHeader
+//   uint16_t back[MAP_HEIGHT * MAP_WIDTH]      -- background tile cells
+//   uint16_t items[MAP_HEIGHT * MAP_WIDTH]     -- item tile cells, 0 where nothing is drawn
+//   char objects[MAP_HEIGHT][MAP_WIDTH]        -- collision grid from X.mashgraph
+//   int32_t holes[hole_count][2], guards[guard_count][2], pearls[pearl_count][2]  -- spawn points, pixels
+constexpr char ROOM_MAGIC[4] = {'L', 'D', 'R', 'M'};
+constexpr uint32_t ROOM_VERSION = 2;  // 2: every spawn of a row, not just the first
+
+struct RoomHeader {
+    char magic[4];
+    uint32_t version;
+    uint16_t width;
+    uint16_t height;
+    uint32_t hole_count;
+    uint32_t guard_count;
+    uint32_t pearl_count;
+};
+
+// Everything ComposeBackground and RoomEquip need to know about one room type
+struct RoomData {
+    std::array<uint16_t, MAP_WIDTH * MAP_HEIGHT> back{};
+    std::array<uint16_t, MAP_WIDTH * MAP_HEIGHT> items{};
+    std::array<char[MAP_WIDTH + 1], MAP_HEIGHT> objects{};
+    std::vector<Point<int>> holes, guards, pearls;
+
+    // parses rooms_dir/X_back.csv, X_items.csv and X.mashgraph
+    bool ParseText(const std::string &rooms_dir, char type);
+    bool Load(const std::string &path);
+    bool Save(const std::string &path) const;
+};
+
+// copy of a 16x16 tile with the cell's flip flags applied
+Image OrientTile(const Image &tile, uint16_t cell);
+
+#endif  // MAIN_ROOM_H
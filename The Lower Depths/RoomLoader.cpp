@@ -0,0 +1,74 @@
+#include "RoomLoader.h"
+
+#include <algorithm>
+
+RoomLoader::RoomLoader(Prepare prepare) : prepare_(std::move(prepare)),
+                                          worker_(&RoomLoader::WorkerLoop, this) {}
+
+RoomLoader::~RoomLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    worker_.join();
+}
+
+void RoomLoader::Request(char type, bool urgent) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.count(type)) {
+            auto queued = std::find(queue_.begin(), queue_.end(), type);
+            if (!urgent || queued == queue_.end()) {
+                return;  // already queued, or already being prepared
+            }
+            queue_.erase(queued);
+        } else {
+            auto &[promise, future] = pending_[type];
+            future = promise.get_future().share();
+        }
+        if (urgent) {
+            queue_.push_front(type);
+        } else {
+            queue_.push_back(type);
+        }
+    }
+    wake_.notify_one();
+}
+
+PreparedRoom RoomLoader::Get(char type) {
+    std::shared_future<PreparedRoom> future;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(type);
+        if (it != pending_.end()) {
+            future = it->second.second;
+            auto queued = std::find(queue_.begin(), queue_.end(), type);
+            if (queued != queue_.end()) {  // not started yet, make it next
+                queue_.erase(queued);
+                queue_.push_front(type);
+            }
+        }
+    }
+    return future.valid() ? future.get() : prepare_(type);
+}
+
+void RoomLoader::WorkerLoop() {
+    while (true) {
+        char type;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+            type = queue_.front();
+            queue_.pop_front();
+        }
+        PreparedRoom room = prepare_(type);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(type);
+        it->second.first.set_value(std::move(room));
+        pending_.erase(it);  // waiters hold the shared_future, which keeps the result alive
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef MAIN_ROOM_LOADER_H
+#define MAIN_ROOM_LOADER_H
+
+#include "Image.h"
+#include "Room.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// a room ready to be swapped in: its data and composited background
+struct PreparedRoom {
+    std::shared_ptr<const RoomData> data;
+    std::shared_ptr<const Image> background;
+};
+
+// Prepares rooms on a background thread. The prepare callback must be thread-safe;
+// results are not kept here (the caller's caches own them), only rooms in flight are.
+class RoomLoader {
+public:
+    using Prepare = std::function<PreparedRoom(char type)>;
+
+    explicit RoomLoader(Prepare prepare);
+    ~RoomLoader();
+    RoomLoader(const RoomLoader &) = delete;
+    RoomLoader &operator =(const RoomLoader &) = delete;
+
+    // queues a room type; urgent requests jump the queue, speculative ones wait their turn
+    void Request(char type, bool urgent);
+    // the prepared room: waits if it is queued or in progress, prepares it inline otherwise
+    PreparedRoom Get(char type);
+
+private:
+    void WorkerLoop();
+
+    Prepare prepare_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<char> queue_;
+    std::map<char, std::pair<std::promise<PreparedRoom>, std::shared_future<PreparedRoom>>> pending_;
+    bool stop_ = false;
+    std::thread worker_;  // last: starts once everything above is constructed
+};
+
+#endif  // MAIN_ROOM_LOADER_H
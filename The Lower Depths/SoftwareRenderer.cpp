@@ -0,0 +1,155 @@
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+Rect Rect::Intersect(const Rect &other) const {
+    return {std::max(x0, other.x0), std::max(y0, other.y0), std::min(x1, other.x1), std::min(y1, other.y1)};
+}
+
+Rect Rect::Union(const Rect &other) const {
+    return {std::min(x0, other.x0), std::min(y0, other.y0), std::max(x1, other.x1), std::max(y1, other.y1)};
+}
+
+static Rect CommandRect(const DrawCommand &cmd) {
+    return {cmd.pos.x, cmd.pos.y, cmd.pos.x + cmd.image->width(), cmd.pos.y + cmd.image->height()};
+}
+
+static bool SameCommand(const DrawCommand &a, const DrawCommand &b) {
+    return a.pos == b.pos && a.image == b.image && a.mode == b.mode;
+}
+
+SoftwareRenderer::SoftwareRenderer(ThreadPool *pool)
+        : pool_(pool),
+          tiles_x_((frame_.width() + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE),
+          tiles_y_((frame_.height() + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE),
+          bins_(tiles_x_ * tiles_y_) {
+    frame_.FillImage(BG_COLOR);
+}
+
+void SoftwareRenderer::Render(const FrameSnapshot &frame) {
+    const DrawCommands &commands = frame.commands;
+    double fade = std::min(frame.fade, 1.0);
+    dirty_.clear();
+    // the fade overlay covers everything, and so does the first frame after it
+    if (!dirty_tracking_ || !prev_valid_ || fade > 0) {
+        dirty_.push_back(Bounds());
+    } else {
+        FindDirtyRects(commands);
+    }
+
+    stats_ = {0, Bounds().Area(), static_cast<int>(dirty_.size())};
+    for (const Rect &rect : dirty_) {
+        stats_.touched_pixels += rect.Area();
+    }
+    BinTiles(commands);
+    uint8_t fade_alpha = fade > 0 ? static_cast<uint8_t>(std::lround(fade * 255)) : 0;
+    if (pool_ && items_.size() > 1) {
+        pool_->ParallelFor(items_.size(), [&](size_t i) { Composite(commands, i, fade_alpha); });
+    } else {
+        for (size_t i = 0; i < items_.size(); ++i) {
+            Composite(commands, i, fade_alpha);
+        }
+    }
+    prev_.assign(commands.begin(), commands.end());
+    prev_valid_ = fade <= 0;
+}
+
+void SoftwareRenderer::FindDirtyRects(const DrawCommands &commands) {
+    // compared by index: a command inserted or removed mid-list marks everything after it,
+    // which over-approximates but never misses a change
+    size_t common = std::min(prev_.size(), commands.size());
+    for (size_t i = 0; i < common; ++i) {
+        if (!SameCommand(prev_[i], commands[i])) {
+            AddDirty(CommandRect(prev_[i]));
+            AddDirty(CommandRect(commands[i]));
+        }
+    }
+    for (size_t i = common; i < prev_.size(); ++i) {
+        AddDirty(CommandRect(prev_[i]));
+    }
+    for (size_t i = common; i < commands.size(); ++i) {
+        AddDirty(CommandRect(commands[i]));
+    }
+}
+
+void SoftwareRenderer::AddDirty(Rect rect) {
+    rect = rect.Intersect(Bounds());
+    if (rect.Empty()) {
+        return;
+    }
+    // overlapping rectangles are merged so no pixel is composited twice; a merge can make
+    // the result overlap rectangles checked earlier, so rescan until nothing changes
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < dirty_.size(); ++i) {
+            if (!dirty_[i].Intersect(rect).Empty()) {
+                rect = rect.Union(dirty_[i]);
+                dirty_[i] = dirty_.back();
+                dirty_.pop_back();
+                merged = true;
+                break;
+            }
+        }
+    }
+    dirty_.push_back(rect);
+}
+
+void SoftwareRenderer::BinTiles(const DrawCommands &commands) {
+    for (auto &bin : bins_) {
+        bin.clear();
+    }
+    items_.clear();
+    for (uint32_t i = 0; i < commands.size(); ++i) {
+        Rect rect = CommandRect(commands[i]).Intersect(Bounds());
+        if (rect.Empty()) {
+            continue;
+        }
+        for (int ty = rect.y0 / RENDER_TILE_SIZE; ty <= (rect.y1 - 1) / RENDER_TILE_SIZE; ++ty) {
+            for (int tx = rect.x0 / RENDER_TILE_SIZE; tx <= (rect.x1 - 1) / RENDER_TILE_SIZE; ++tx) {
+                bins_[ty * tiles_x_ + tx].push_back(i);
+            }
+        }
+    }
+    for (const Rect &rect : dirty_) {
+        for (int ty = rect.y0 / RENDER_TILE_SIZE; ty <= (rect.y1 - 1) / RENDER_TILE_SIZE; ++ty) {
+            for (int tx = rect.x0 / RENDER_TILE_SIZE; tx <= (rect.x1 - 1) / RENDER_TILE_SIZE; ++tx) {
+                Rect tile{tx * RENDER_TILE_SIZE, ty * RENDER_TILE_SIZE,
+                          (tx + 1) * RENDER_TILE_SIZE, (ty + 1) * RENDER_TILE_SIZE};
+                items_.push_back({ty * tiles_x_ + tx, rect.Intersect(tile)});
+            }
+        }
+    }
+}
+
+// dirty rects are disjoint and so are tiles: items never write the same pixel
+void SoftwareRenderer::Composite(const DrawCommands &commands, size_t item, uint8_t fade_alpha) {
+    const Rect &clip = items_[item].clip;
+    for (int y = clip.y0; y < clip.y1; ++y) {
+        std::fill_n(frame_.data() + y * frame_.stride() + clip.x0, clip.x1 - clip.x0, BG_COLOR);
+    }
+    for (uint32_t i : bins_[items_[item].tile]) {
+        Draw(commands[i].pos, *commands[i].image, commands[i].mode, clip);
+    }
+    if (fade_alpha > 0) {
+        for (int y = clip.y0; y < clip.y1; ++y) {
+            BlendRowConstant(frame_.data() + y * frame_.stride() + clip.x0, BG_COLOR, fade_alpha, clip.x1 - clip.x0);
+        }
+    }
+}
+
+void SoftwareRenderer::Draw(Point<int> pos, const Image &img, BlendMode mode, const Rect &clip) {
+    Rect rect = Rect{pos.x, pos.y, pos.x + img.width(), pos.y + img.height()}.Intersect(clip);
+    if (rect.Empty()) {
+        return;
+    }
+    for (int y = rect.y0; y < rect.y1; ++y) {
+        Pixel *dst = frame_.data() + y * frame_.stride() + rect.x0;
+        const Pixel *src = img.data() + (y - pos.y) * img.stride() + (rect.x0 - pos.x);
+        if (mode == BlendMode::EFFECT) {
+            BlendRowEffect(dst, src, rect.x1 - rect.x0);
+        } else {
+            BlendRowAlpha(dst, src, rect.x1 - rect.x0);
+        }
+    }
+}
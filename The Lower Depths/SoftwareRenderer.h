@@ -0,0 +1,83 @@
+#ifndef MAIN_SOFTWARE_RENDERER_H
+#define MAIN_SOFTWARE_RENDERER_H
+
+#include "Image.h"
+#include "Blend.h"
+#include "DrawCommands.h"
+#include "Game.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+// half-open pixel rectangle [x0, x1) x [y0, y1)
+struct Rect {
+    int x0, y0, x1, y1;
+
+    bool Empty() const { return x0 >= x1 || y0 >= y1; }
+    int64_t Area() const { return Empty() ? 0 : int64_t(x1 - x0) * (y1 - y0); }
+    Rect Intersect(const Rect &other) const;
+    Rect Union(const Rect &other) const;
+};
+
+struct RenderStats {
+    int64_t touched_pixels = 0;  // recomposited this frame
+    int64_t frame_pixels = 0;    // what a full redraw would touch
+    int dirty_rects = 0;
+};
+
+// CPU compositor producing the same frame GameRender + GameEffects draw with OpenGL,
+// at the game's native resolution. Needs no GL context.
+// The frame persists between Render() calls: only the areas covered by commands that
+// differ from the previous frame's are recomposited, the rest is left as it was.
+// Dirty areas are cut along a grid of RENDER_TILE_SIZE tiles, commands are binned per
+// tile, and with a pool the tiles composite in parallel. Every pixel still sees the same
+// kernels in the same order, so the frame is identical to the serial one.
+constexpr int RENDER_TILE_SIZE = 64;
+
+class SoftwareRenderer {
+public:
+    // pool: composites tiles on it (it must outlive the renderer); null renders serially
+    explicit SoftwareRenderer(ThreadPool *pool = nullptr);
+
+    // composites the frame's commands and the room fade overlay into Frame()
+    void Render(const FrameSnapshot &frame);
+    const Image &Frame() const { return frame_; }
+    Image &Frame() { return frame_; }
+
+    // off: every frame is recomposited in full (for comparison)
+    void SetDirtyTracking(bool on) { dirty_tracking_ = on; }
+    // of the last Render()
+    const RenderStats &Stats() const { return stats_; }
+
+private:
+    // collects the areas where this frame's commands differ from prev_
+    void FindDirtyRects(const DrawCommands &commands);
+    void AddDirty(Rect rect);
+    // splits the dirty rects along the tile grid and bins the commands of each tile
+    void BinTiles(const DrawCommands &commands);
+    // redraws one area from scratch: clear, then the tile's commands that overlap it,
+    // then the fade overlay if there is one
+    void Composite(const DrawCommands &commands, size_t item, uint8_t fade_alpha);
+    // draws img with its top-left corner at pos, clipped to clip
+    void Draw(Point<int> pos, const Image &img, BlendMode mode, const Rect &clip);
+    Rect Bounds() const { return {0, 0, frame_.width(), frame_.height()}; }
+
+    Image frame_{MAP_WIDTH * TILE_SIZE, MAP_HEIGHT * TILE_SIZE};
+    bool dirty_tracking_ = true;
+    std::vector<DrawCommand> prev_;  // last frame's commands, capacity reused
+    bool prev_valid_ = false;        // false until a fade-free frame has been drawn
+    std::vector<Rect> dirty_;
+    RenderStats stats_;
+
+    struct WorkItem {
+        int tile;
+        Rect clip;  // part of a dirty rect inside the tile
+    };
+    ThreadPool *pool_;
+    int tiles_x_, tiles_y_;
+    std::vector<std::vector<uint32_t>> bins_;  // command indices by tile, capacity reused
+    std::vector<WorkItem> items_;
+};
+
+#endif  // MAIN_SOFTWARE_RENDERER_H
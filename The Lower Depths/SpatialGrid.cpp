@@ -0,0 +1,56 @@
+#include "SpatialGrid.h"
+
+void SpatialGrid::Build(const Entities &e) {
+    for (auto &bucket : buckets_) {
+        bucket.clear();
+    }
+    bucket_of_.resize(e.Size());
+    slot_.resize(e.Size());
+    for (uint32_t i = 0; i < e.Size(); ++i) {
+        Insert(i, Bucket(e, i));
+    }
+}
+
+void SpatialGrid::Insert(uint32_t i, uint32_t bucket) {
+    bucket_of_[i] = bucket;
+    slot_[i] = buckets_[bucket].size();
+    buckets_[bucket].push_back(i);
+}
+
+void SpatialGrid::Update(const Entities &e) {
+    for (uint32_t i = 0; i < e.Size(); ++i) {
+        uint32_t bucket = Bucket(e, i);
+        if (bucket == bucket_of_[i]) {
+            continue;
+        }
+        // out of the old bucket by swapping the last one into its slot
+        auto &old = buckets_[bucket_of_[i]];
+        uint32_t last = old.back();
+        old[slot_[i]] = last;
+        slot_[last] = slot_[i];
+        old.pop_back();
+        Insert(i, bucket);
+    }
+}
+
+bool SpatialGrid::Nearest(const Entities &e, Point<int> pos, int radius, size_t &found) const {
+    int best = radius * radius;
+    size_t best_i = e.Size();
+    Query(pos, radius, [&](uint32_t i) {
+        int dist = pos.SqrDist(e.PixelPos(i));
+        if (dist < best || (dist == best && i < best_i)) {
+            best = dist;
+            best_i = i;
+        }
+    });
+    found = best_i;
+    return best_i < e.Size();
+}
+
+bool SpatialGrid::AnyWithin(const Entities &e, Point<int> pos, int radius) const {
+    bool any = false;
+    Query(pos, radius, [&](uint32_t i) {
+        any = any || (e.alive[i] && pos.SqrDist(e.PixelPos(i)) <= radius * radius);
+    });
+    return any;
+}
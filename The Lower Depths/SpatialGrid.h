@@ -0,0 +1,60 @@
+#ifndef MAIN_SPATIAL_GRID_H
+#define MAIN_SPATIAL_GRID_H
+
+#include "Entities.h"
+#include "Room.h"
+#include "structs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+constexpr int SPATIAL_CELL_SHIFT = 5;  // buckets are 32 px squares, about one sprite
+constexpr int SPATIAL_CELL_SIZE = 1 << SPATIAL_CELL_SHIFT;
+
+// Uniform grid over the room indexing one Entities store by whole-pixel position, one
+// bucket per SPATIAL_CELL_SIZE square; positions off the room go to the edge buckets.
+// Update() only moves entities whose bucket changed since the last call, so keeping up
+// with moving entities is one compare each. A query looks at the few buckets around a
+// point instead of every entity.
+class SpatialGrid {
+public:
+    // indexes entities [0, e.Size()), dropping whatever was indexed before
+    void Build(const Entities &e);
+    // catches up with moved entities; e must be the store of the last Build()
+    void Update(const Entities &e);
+
+    // fn(i) for every entity in the buckets overlapping the square of radius around pos;
+    // some may be further than radius, callers check the exact distance
+    template<class F>
+    void Query(Point<int> pos, int radius, F fn) const {
+        int col0 = Col(pos.x - radius), col1 = Col(pos.x + radius);
+        int row0 = Row(pos.y - radius), row1 = Row(pos.y + radius);
+        for (int row = row0; row <= row1; ++row) {
+            for (int col = col0; col <= col1; ++col) {
+                for (uint32_t i : buckets_[row * cols_ + col]) {
+                    fn(i);
+                }
+            }
+        }
+    }
+    // the nearest entity within radius, taken or not, lowest index on ties; false if none
+    bool Nearest(const Entities &e, Point<int> pos, int radius, size_t &found) const;
+    // whether an alive entity is within radius (inclusive)
+    bool AnyWithin(const Entities &e, Point<int> pos, int radius) const;
+
+private:
+    constexpr static int cols_ = (MAP_WIDTH * TILE_SIZE + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE;
+    constexpr static int rows_ = (MAP_HEIGHT * TILE_SIZE + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE;
+
+    static int Col(int x) { return std::clamp(x >> SPATIAL_CELL_SHIFT, 0, cols_ - 1); }
+    static int Row(int y) { return std::clamp(y >> SPATIAL_CELL_SHIFT, 0, rows_ - 1); }
+    static uint32_t Bucket(const Entities &e, size_t i) { return Row(e.py[i]) * cols_ + Col(e.px[i]); }
+    void Insert(uint32_t i, uint32_t bucket);
+
+    std::vector<std::vector<uint32_t>> buckets_ = std::vector<std::vector<uint32_t>>(cols_ * rows_);
+    std::vector<uint32_t> bucket_of_;  // per entity
+    std::vector<uint32_t> slot_;       // per entity: its index inside its bucket
+};
+
+#endif  // MAIN_SPATIAL_GRID_H
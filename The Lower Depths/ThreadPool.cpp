@@ -0,0 +1,71 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threads) {
+    for (unsigned i = 1; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)> &fn) {
+    if (count == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        count_ = count;
+        finished_ = 0;
+        next_ = 0;
+        ++generation_;
+    }
+    wake_.notify_all();
+    size_t done = Drain(fn, count);
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_ += done;
+    done_.wait(lock, [&] { return finished_ == count_ && active_ == 0; });
+    job_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        const std::function<void(size_t)> *job;
+        size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || (generation_ != seen && job_); });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+            job = job_;
+            count = count_;
+            ++active_;
+        }
+        size_t done = Drain(*job, count);
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ += done;
+        --active_;
+        done_.notify_one();
+    }
+}
+
+size_t ThreadPool::Drain(const std::function<void(size_t)> &fn, size_t count) {
+    size_t done = 0;
+    for (size_t i = next_++; i < count; i = next_++) {
+        fn(i);
+        ++done;
+    }
+    return done;
+}
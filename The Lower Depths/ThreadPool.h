@@ -0,0 +1,43 @@
+#ifndef MAIN_THREAD_POOL_H
+#define MAIN_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads includes the calling thread, which always helps out
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator =(const ThreadPool &) = delete;
+
+    unsigned Size() const { return workers_.size() + 1; }
+
+    // runs fn(0) ... fn(count - 1) on the pool, returns once all of them are done.
+    // Indices are handed out dynamically, so uneven jobs balance themselves.
+    // One ParallelFor at a time: fn must not call it on the same pool.
+    void ParallelFor(size_t count, const std::function<void(size_t)> &fn);
+
+private:
+    void WorkerLoop();
+    size_t Drain(const std::function<void(size_t)> &fn, size_t count);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    const std::function<void(size_t)> *job_ = nullptr;
+    size_t count_ = 0;
+    size_t finished_ = 0;
+    unsigned active_ = 0;  // workers inside the current job; it ends only when they have all left
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+    std::atomic<size_t> next_{0};
+};
+
+#endif  // MAIN_THREAD_POOL_H
@@ -0,0 +1,38 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free handoff of the latest value from one writer thread to one reader thread.
+// The writer fills Back() and publishes it; the reader picks up the newest published
+// value and reads Front() for as long as it likes. Neither side ever waits, and values
+// nobody picked up in time are simply overwritten.
+template<class T>
+class TripleBuffer {
+public:
+    // writer side: the slot to fill, then Publish() it
+    T &Back() { return slots_[back_]; }
+    void Publish() {
+        back_ = middle_.exchange(back_ | fresh_, std::memory_order_acq_rel) & index_;
+    }
+
+    // reader side: switches Front() to the newest published value; false if there is none
+    bool Acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & fresh_)) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & index_;
+        return true;
+    }
+    const T &Front() const { return slots_[front_]; }
+
+private:
+    constexpr static uint8_t index_ = 3, fresh_ = 4;
+    std::array<T, 3> slots_{};
+    uint8_t back_ = 0, front_ = 1;     // owned by the writer and the reader
+    std::atomic<uint8_t> middle_{2};   // slot index, plus fresh_ once published
+};
+
+#endif
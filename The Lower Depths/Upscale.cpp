@@ -0,0 +1,77 @@
+#include "Upscale.h"
+
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UPSCALE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+#ifdef UPSCALE_SSE2
+
+// _mm_shuffle_epi32 control for output vector K of a four-pixel group: lane j takes
+// source pixel (4K + j) / SCALE, e.g. abcd -> aaab bbcc cddd for SCALE 3
+template<int SCALE, int K>
+constexpr int REPLICATE_SHUFFLE = (4 * K + 0) / SCALE | (4 * K + 1) / SCALE << 2 |
+                                  (4 * K + 2) / SCALE << 4 | (4 * K + 3) / SCALE << 6;
+
+template<int SCALE, size_t... K>
+inline void StoreReplicated(Pixel *dst, __m128i v, std::index_sequence<K...>) {
+    (_mm_storeu_si128(reinterpret_cast<__m128i *>(dst) + K, _mm_shuffle_epi32(v, REPLICATE_SHUFFLE<SCALE, K>)), ...);
+}
+
+#endif  // UPSCALE_SSE2
+
+template<int SCALE>
+void UpscaleRow(Pixel *dst, const Pixel *src, int n) {
+    int i = 0;
+#ifdef UPSCALE_SSE2
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        StoreReplicated<SCALE>(dst + i * SCALE, v, std::make_index_sequence<SCALE>());
+    }
+#endif
+    for (; i < n; ++i) {
+        for (int k = 0; k < SCALE; ++k) {
+            dst[i * SCALE + k] = src[i];
+        }
+    }
+}
+
+}  // namespace
+
+template<int SCALE>
+void UpscaleNearest(const Image &src, Image &dst, bool flip_y) {
+    static_assert(SCALE >= 1 && SCALE <= MAX_UPSCALE);
+    int width = src.width() * SCALE, height = src.height() * SCALE;
+    if (dst.width() != width || dst.height() != height) {
+        dst = Image(width, height);
+    }
+    for (int y = 0; y < src.height(); ++y) {
+        int row = (flip_y ? src.height() - 1 - y : y) * SCALE;
+        Pixel *out = dst.data() + row * dst.stride();
+        UpscaleRow<SCALE>(out, src.data() + y * src.stride(), src.width());
+        // the other rows of the block are plain copies of the first
+        for (int k = 1; k < SCALE; ++k) {
+            std::memcpy(out + k * dst.stride(), out, width * sizeof(Pixel));
+        }
+    }
+}
+
+template void UpscaleNearest<1>(const Image &, Image &, bool);
+template void UpscaleNearest<2>(const Image &, Image &, bool);
+template void UpscaleNearest<3>(const Image &, Image &, bool);
+template void UpscaleNearest<4>(const Image &, Image &, bool);
+
+bool UpscaleNearest(const Image &src, Image &dst, int scale, bool flip_y) {
+    switch (scale) {
+        case 1: UpscaleNearest<1>(src, dst, flip_y); return true;
+        case 2: UpscaleNearest<2>(src, dst, flip_y); return true;
+        case 3: UpscaleNearest<3>(src, dst, flip_y); return true;
+        case 4: UpscaleNearest<4>(src, dst, flip_y); return true;
+        default: return false;
+    }
+}
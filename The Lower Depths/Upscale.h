@@ -0,0 +1,17 @@
+#ifndef MAIN_UPSCALE_H
+#define MAIN_UPSCALE_H
+
+#include "Image.h"
+
+// Nearest-neighbour integer upscaling, the CPU counterpart of glPixelZoom(s, -s).
+// Every source pixel becomes an s x s block of dst; flip_y puts source row 0 at the
+// bottom, as GL expects rows. dst is reallocated unless it is already
+// src.width() * s x src.height() * s. SSE2 replicates four pixels per shuffle.
+constexpr int MAX_UPSCALE = 4;
+
+template<int SCALE>
+void UpscaleNearest(const Image &src, Image &dst, bool flip_y = false);
+// dispatches to the template; false for a scale outside 1..MAX_UPSCALE
+bool UpscaleNearest(const Image &src, Image &dst, int scale, bool flip_y = false);
+
+#endif  // MAIN_UPSCALE_H
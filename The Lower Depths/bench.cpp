@@ -0,0 +1,447 @@
+// Micro-benchmarks. Run from bin/ like the game itself: ./bench [name ...]
+#include "Image.h"
+#include "Blend.h"
+#include "Bundle.h"
+#include "Entities.h"
+#include "Game.h"
+#include "Lab.h"
+#include "Room.h"
+#include "SoftwareRenderer.h"
+#include "SpatialGrid.h"
+#include "Upscale.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const std::string MAP_DESIGN = "../map_design/";
+
+// runs fn `reps` times and prints the best and mean wall time
+template<class F>
+double Measure(const std::string &name, int reps, F fn) {
+    double best = 1e30, total = 0;
+    for (int i = 0; i < reps; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+        total += elapsed.count();
+    }
+    std::cout << "  " << name << ": best " << best << " ms, mean " << total / reps << " ms" << std::endl;
+    return best;
+}
+
+void BenchStartup() {
+    std::vector<std::string> pngs;
+    for (const char *dir : {"tiles", "sprites", "objects"}) {
+        for (const auto &file : fs::directory_iterator(MAP_DESIGN + dir)) {
+            if (file.path().extension() == ".png") {
+                pngs.push_back(file.path().string());
+            }
+        }
+    }
+    std::cout << "startup (" << pngs.size() << " assets, warm page cache)" << std::endl;
+    double png = Measure("decode PNGs", 5, [&] {
+        for (const auto &path : pngs) {
+            Image img(path);
+        }
+    });
+    double bundle = Measure("map bundle", 5, [&] {
+        AssetBundle bundle;
+        if (!bundle.Open(MAP_DESIGN + "assets.bundle")) {
+            std::cerr << "  no bundle, build the `assets` target first" << std::endl;
+        }
+        Image atlas = bundle.View(ATLAS_NAME);
+        for (const auto &path : pngs) {
+            fs::path rel = fs::path(path).lexically_relative(MAP_DESIGN);
+            if (rel.parent_path() == "tiles") {
+                AtlasTile(atlas, std::stoi(rel.stem().string()));
+            } else {
+                bundle.View((rel.parent_path() / rel.stem()).generic_string());
+            }
+        }
+    });
+    std::cout << "  speedup: " << png / bundle << "x" << std::endl;
+    Measure("Game::Game()", 5, [] { Game game; });
+}
+
+void BenchRooms() {
+    std::string types;
+    for (const auto &file : fs::directory_iterator(MAP_DESIGN + "rooms")) {
+        if (file.path().extension() == ".mashgraph") {
+            types += file.path().stem().string();
+        }
+    }
+    std::cout << "rooms (" << types.size() << " room types, per room)" << std::endl;
+    constexpr int reps = 20;
+    double text = Measure("parse CSV + .mashgraph", reps, [&] {
+        for (char type : types) {
+            RoomData room;
+            room.ParseText(MAP_DESIGN + "rooms/", type);
+        }
+    }) / types.size();
+    double blob = Measure("load .room blob", reps, [&] {
+        for (char type : types) {
+            RoomData room;
+            room.Load(MAP_DESIGN + "rooms/" + type + ".room");
+        }
+    }) / types.size();
+    std::cout << "  per room: " << text * 1000 << " us text, " << blob * 1000 << " us blob" << std::endl;
+}
+
+void BenchBlend() {
+    // one frame's worth of rows, sources with the opaque / transparent / partial mix of sprites
+    constexpr int width = TILE_SIZE * MAP_WIDTH, height = TILE_SIZE * MAP_HEIGHT, reps = 50;
+    std::mt19937 rng(42);
+    std::vector<Pixel> src(width * height), dst(width * height), out(width * height);
+    for (Pixel &p : src) {
+        uint32_t v = rng();
+        uint8_t a = v % 3 == 0 ? 0 : v % 3 == 1 ? 255 : static_cast<uint8_t>(v >> 24);
+        p = {static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v >> 16), a};
+    }
+    for (Pixel &p : dst) {
+        uint32_t v = rng();
+        p = {static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v >> 16), 255};
+    }
+    std::vector<std::pair<std::string, void (*)(Pixel *, const Pixel *, int)>> kernels{
+        {"CopyRowMasked", CopyRowMasked},
+        {"BlendRowAlpha", BlendRowAlpha},
+        {"BlendRowEffect", BlendRowEffect},
+    };
+    BlendIsa active = ActiveBlendIsa();
+    std::cout << "blend (" << width << "x" << height << " frame, dispatch picks "
+              << BlendIsaName(active) << ")" << std::endl;
+    std::map<std::string, std::vector<Pixel>> reference;
+    for (BlendIsa isa : {BlendIsa::SCALAR, BlendIsa::SSE2, BlendIsa::AVX2}) {
+        if (!SetBlendIsa(isa)) {
+            std::cout << "  " << BlendIsaName(isa) << ": not supported" << std::endl;
+            continue;
+        }
+        for (const auto &[name, kernel] : kernels) {
+            double ms = Measure(std::string(BlendIsaName(isa)) + " " + name, reps, [&, kernel = kernel] {
+                out = dst;
+                for (int y = 0; y < height; ++y) {
+                    kernel(out.data() + y * width, src.data() + y * width, width);
+                }
+            });
+            std::cout << "    " << width * height / ms / 1000 << " MP/s" << std::endl;
+            auto [it, first] = reference.emplace(name, out);
+            if (!first && std::memcmp(it->second.data(), out.data(), out.size() * sizeof(Pixel)) != 0) {
+                std::cerr << "    result differs from scalar" << std::endl;
+            }
+        }
+    }
+    SetBlendIsa(active);
+}
+
+void BenchRender() {
+    // the headless loop without input: sprites animate over a static room background
+    constexpr int frames = 300;
+    constexpr double frame_time = 1.0 / 60;
+    Game game;
+    ThreadPool pool;
+    std::cout << "render (" << frames << " frames, software compositor, "
+              << pool.Size() << " threads for tiles)" << std::endl;
+    struct Variant {
+        const char *name;
+        SoftwareRenderer renderer;
+        std::chrono::duration<double, std::milli> time{};
+        int64_t touched = 0, total = 0;
+        bool identical = true;
+    };
+    // the first one is the reference: serial full redraws
+    Variant variants[] = {{"serial, full redraw", SoftwareRenderer(nullptr)},
+                          {"serial, dirty rects", SoftwareRenderer(nullptr)},
+                          {"tiles, full redraw", SoftwareRenderer(&pool)},
+                          {"tiles, dirty rects", SoftwareRenderer(&pool)}};
+    variants[0].renderer.SetDirtyTracking(false);
+    variants[2].renderer.SetDirtyTracking(false);
+    FrameSnapshot snapshot;
+    for (int frame = 0; frame < frames; ++frame) {
+        game.Snapshot(snapshot);
+        for (Variant &variant : variants) {
+            auto start = std::chrono::steady_clock::now();
+            variant.renderer.Render(snapshot);
+            variant.time += std::chrono::steady_clock::now() - start;
+            variant.touched += variant.renderer.Stats().touched_pixels;
+            variant.total += variant.renderer.Stats().frame_pixels;
+            const Image &reference = variants[0].renderer.Frame();
+            variant.identical = variant.identical &&
+                std::memcmp(variant.renderer.Frame().data(), reference.data(), reference.size()) == 0;
+        }
+        for (int ticks = game.UpdTime((frame + 1) * frame_time); ticks > 0; --ticks) {
+            game.BeginTick();
+            game.MoveGuards();
+            game.RoomChangeCheck();
+        }
+    }
+    for (const Variant &variant : variants) {
+        std::cout << "  " << variant.name << ": " << variant.time.count() / frames << " ms per frame, "
+                  << 100.0 * variant.touched / variant.total << "% of pixels" << std::endl;
+        if (!variant.identical) {
+            std::cerr << "    frames differ from serial full redraws" << std::endl;
+        }
+    }
+}
+
+void BenchMove() {
+    constexpr int moves = 1000000;
+    std::cout << "move (" << moves << " calls)" << std::endl;
+    RoomData room;
+    if (!room.Load(MAP_DESIGN + "rooms/@.room")) {
+        room.ParseText(MAP_DESIGN + "rooms/", '@');
+    }
+    // the nine probes of one Move, the old way and with the CELL_* grid
+    CellGrid cells = BuildCellGrid(room.objects);
+    int hits = 0;
+    double map_ms = Measure("probe with std::map<char, bool>", 5, [&] {
+        for (int i = 0; i < moves; ++i) {
+            int x = i % ((MAP_WIDTH - 2) * TILE_SIZE), y = i / 7 % ((MAP_HEIGHT - 3) * TILE_SIZE);
+            std::map<char, bool> collisions;
+            for (int dy : {16, 32, 40}) {
+                for (int dx: {0, 16, 18}) {
+                    collisions[room.objects[(y + dy) / TILE_SIZE][(x + dx) / TILE_SIZE]] = true;
+                }
+            }
+            hits += collisions['#'];
+        }
+    });
+    double mask_ms = Measure("probe with the cell bitmask", 5, [&] {
+        for (int i = 0; i < moves; ++i) {
+            int x = i % ((MAP_WIDTH - 2) * TILE_SIZE), y = i / 7 % ((MAP_HEIGHT - 3) * TILE_SIZE);
+            uint8_t collisions = 0;
+            for (int dy : {16, 32, 40}) {
+                for (int dx: {0, 16, 18}) {
+                    collisions |= cells[(y + dy) / TILE_SIZE * MAP_WIDTH + (x + dx) / TILE_SIZE];
+                }
+            }
+            hits += collisions & CELL_WALL;
+        }
+    });
+    std::cout << "  speedup: " << map_ms / mask_ms << "x (" << hits << " wall hits)" << std::endl;
+    Measure("SweepBox, 16 px in a random direction", 5, [&] {
+        Point<double> pos{ROOM_X_CENTER * TILE_SIZE, ROOM_Y_CENTER * TILE_SIZE - 20};
+        for (int i = 0; i < moves; ++i) {
+            uint8_t touched;
+            pos = SweepBox(cells, pos, {0, 16, 19, 41}, static_cast<Direction>(i * 7 / 5 % 4), 16, CELL_WALL, touched);
+            hits += touched;
+        }
+    });
+
+    FlowField flow;
+    Measure("FlowField::Build, 1000 targets", 5, [&] {
+        for (int i = 0; i < 1000; ++i) {
+            flow.Build(cells, {i % MAP_WIDTH, i / MAP_WIDTH % MAP_HEIGHT}, CELL_WALL | CELL_EXIT);
+        }
+    });
+
+    // the real thing: the player paces left and right in the start room once it has faded in
+    Game game;
+    for (int frame = 1; frame <= 60; ++frame) {
+        for (int ticks = game.UpdTime(frame / 60.0); ticks > 0; --ticks) {
+            game.BeginTick();
+            game.RoomChangeCheck();
+        }
+    }
+    double move_ms = Measure("Game::Move", 5, [&] {
+        for (int i = 0; i < moves; ++i) {
+            game.Move(i / 64 % 2 ? Direction::LEFT : Direction::RIGHT);
+        }
+    });
+    std::cout << "  " << moves / move_ms / 1000 << " M moves/s" << std::endl;
+}
+
+void BenchGuards() {
+    constexpr int64_t guard_steps = 2000000;  // per size, so every size does the same work
+    std::cout << "guards (straight chase, " << guard_steps << " guard steps per size)" << std::endl;
+    const Point<double> target{ROOM_X_CENTER * TILE_SIZE, ROOM_Y_CENTER * TILE_SIZE};
+    Point<int> target_px{ROOM_X_CENTER * TILE_SIZE, ROOM_Y_CENTER * TILE_SIZE};
+    const double step = Game::TICK * 30;
+    for (size_t n = 10; n <= 100000; n *= 10) {
+        std::mt19937 rng(n);
+        std::uniform_int_distribution<int> x_dist(0, MAP_WIDTH * TILE_SIZE), y_dist(0, MAP_HEIGHT * TILE_SIZE);
+        Entities start;
+        for (size_t i = 0; i < n; ++i) {
+            start.Add({x_dist(rng), y_dist(rng)});
+        }
+        Entities branchy = start, kernel = start;
+        int ticks = std::max<int64_t>(1, guard_steps / n);
+        int contacts = 0;
+        std::cout << "  " << n << " guards, " << ticks << " ticks" << std::endl;
+        // what MoveGuards did per guard in the rock: two axes, a branch on each sign
+        double branchy_ms = Measure("  per-guard branches", 3, [&] {
+            for (int tick = 0; tick < ticks; ++tick) {
+                bool flee = tick / 64 % 4 == 3;
+                for (size_t i = 0; i < n; ++i) {
+                    Point<double> pos = branchy.Pos(i);
+                    for (bool horizontal : {false, true}) {
+                        double off = horizontal ? target.x - pos.x : target.y - pos.y;
+                        if (off == 0) {
+                            continue;
+                        }
+                        Direction dir = horizontal ? (off < 0 ? Direction::LEFT : Direction::RIGHT)
+                                                   : (off < 0 ? Direction::UP : Direction::DOWN);
+                        branchy.dir[i] = flee ? Opposite(dir) : dir;
+                        pos = pos.Shift(branchy.dir[i], flee ? step : std::min(step, std::abs(off)));
+                    }
+                    branchy.Place(i, pos);
+                    contacts += branchy.PixelPos(i) == target_px;
+                }
+            }
+        });
+        double kernel_ms = Measure("  ChaseStraight", 3, [&] {
+            for (int tick = 0; tick < ticks; ++tick) {
+                contacts += ChaseStraight(kernel, 0, n, target, target_px, step, tick / 64 % 4 == 3);
+            }
+        });
+        std::cout << "      speedup: " << branchy_ms / kernel_ms << "x, "
+                  << n * ticks / kernel_ms / 1000 << " M guard steps/s (" << contacts << " contacts)" << std::endl;
+        if (branchy.x != kernel.x || branchy.y != kernel.y || branchy.px != kernel.px || branchy.dir != kernel.dir) {
+            std::cerr << "      guards differ from the per-guard loop" << std::endl;
+        }
+
+        // the same guards spread over the room, queried at random points: every guard
+        // against each point, or the grid around it; then what keeping the grid up costs
+        constexpr int queries = 1000, contact = 4;
+        std::vector<Point<int>> points(queries);
+        for (auto &point : points) {
+            point = {x_dist(rng), y_dist(rng)};
+        }
+        SpatialGrid grid;
+        grid.Build(start);
+        int scan_hits = 0, grid_hits = 0;
+        double scan_ms = Measure("  " + std::to_string(queries) + " contact queries, scan every guard", 3, [&] {
+            for (Point<int> point : points) {
+                bool hit = false;
+                for (size_t i = 0; i < n; ++i) {
+                    hit = hit || point.SqrDist(start.PixelPos(i)) <= contact * contact;
+                }
+                scan_hits += hit;
+            }
+        });
+        double grid_ms = Measure("  " + std::to_string(queries) + " contact queries, SpatialGrid", 3, [&] {
+            for (Point<int> point : points) {
+                grid_hits += grid.AnyWithin(start, point, contact);
+            }
+        });
+        std::cout << "      speedup: " << scan_ms / grid_ms << "x" << std::endl;
+        if (scan_hits != grid_hits) {
+            std::cerr << "      contacts differ: " << scan_hits << " scanned, " << grid_hits << " with the grid" << std::endl;
+        }
+        grid.Build(kernel);
+        Measure("  SpatialGrid::Update after each ChaseStraight", 3, [&] {
+            for (int tick = 0; tick < ticks; ++tick) {
+                ChaseStraight(kernel, 0, n, target, target_px, step, tick / 64 % 4 == 3);
+                grid.Update(kernel);
+            }
+        });
+    }
+}
+
+void BenchLab() {
+    constexpr int side = 1000, steps = 1000000;
+    std::string path = (fs::temp_directory_path() / "bench_lab.mashgraph").string();
+    {
+        // random room types, '-' between them, the start in the middle
+        std::mt19937 rng(3);
+        const std::string types = "-ABEFHIJKLNSTVW";
+        std::ofstream fout(path);
+        for (int y = 0; y < side; ++y) {
+            std::string row(side, '-');
+            for (char &cell : row) {
+                cell = types[rng() % types.size()];
+            }
+            if (y == side / 2) {
+                row[side / 2] = '@';
+            }
+            fout << row << '\n';
+        }
+    }
+    std::cout << "lab (" << side << "x" << side << " rooms, " << steps << " steps of a random walk)" << std::endl;
+    Lab lab;
+    Measure("Lab::Open", 3, [&] { lab.Open(path); });
+    Point<int> room = lab.Start();
+    int rooms = 0;
+    std::mt19937 rng(5);
+    double walk_ms = Measure("walk, looking at the four neighbours", 3, [&] {
+        for (int i = 0; i < steps; ++i) {
+            for (Direction dir : {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT}) {
+                rooms += lab.Cell(room.Shift(dir, 1)) != '-';
+            }
+            Point<int> next = room.Shift(static_cast<Direction>(rng() % 4), 1);
+            if (lab.Cell(next) != '-') {
+                room = next;
+            }
+        }
+    });
+    CacheStats stats = lab.Stats();
+    std::cout << "  " << walk_ms * 1e6 / steps / 5 << " ns per lookup; resident " << stats.bytes << " of "
+              << side * side << " bytes, " << stats.misses << " chunk loads (" << rooms << " rooms)" << std::endl;
+    fs::remove(path);
+}
+
+void BenchUpscale() {
+    constexpr int width = TILE_SIZE * MAP_WIDTH, height = TILE_SIZE * MAP_HEIGHT, reps = 50;
+    std::mt19937 rng(7);
+    Image src(width, height);
+    for (int i = 0; i < width * height; ++i) {
+        uint32_t v = rng();
+        src.data()[i] = {static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8),
+                         static_cast<uint8_t>(v >> 16), static_cast<uint8_t>(v >> 24)};
+    }
+    std::cout << "upscale (" << width << "x" << height << " frame, flipped)" << std::endl;
+    for (int scale = 2; scale <= MAX_UPSCALE; ++scale) {
+        Image naive(width * scale, height * scale), fast;
+        double naive_ms = Measure("x" + std::to_string(scale) + " per-pixel loop", reps, [&] {
+            for (int y = 0; y < naive.height(); ++y) {
+                for (int x = 0; x < naive.width(); ++x) {
+                    naive.PutPixel(x, naive.height() - 1 - y, src.GetPixel(x / scale, y / scale));
+                }
+            }
+        });
+        double fast_ms = Measure("x" + std::to_string(scale) + " UpscaleNearest", reps, [&] {
+            UpscaleNearest(src, fast, scale, true);
+        });
+        std::cout << "    speedup: " << naive_ms / fast_ms << "x" << std::endl;
+        if (std::memcmp(naive.data(), fast.data(), naive.size()) != 0) {
+            std::cerr << "    result differs from the per-pixel loop" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    std::map<std::string, std::function<void()>> benches{
+        {"startup", BenchStartup},
+        {"rooms", BenchRooms},
+        {"blend", BenchBlend},
+        {"render", BenchRender},
+        {"move", BenchMove},
+        {"guards", BenchGuards},
+        {"upscale", BenchUpscale},
+        {"lab", BenchLab},
+    };
+    std::vector<std::string> selected(argv + 1, argv + argc);
+    if (selected.empty()) {
+        for (const auto &[name, fn] : benches) {
+            selected.push_back(name);
+        }
+    }
+    for (const auto &name : selected) {
+        auto it = benches.find(name);
+        if (it == benches.end()) {
+            std::cerr << "Unknown benchmark " << name << std::endl;
+            return 1;
+        }
+        it->second();
+    }
+    return 0;
+}
@@ -1,15 +1,25 @@
 #include "Image.h"
 #include "Game.h"
+#include "SoftwareRenderer.h"
+#include "GlRenderer.h"
+#include "Upscale.h"
+#include "SpscQueue.hpp"
+#include "TripleBuffer.hpp"
 #include "common.h"
 
 #include <GLFW/glfw3.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
 
 constexpr int ZOOM_COEF = 2;
 constexpr GLsizei WINDOW_WIDTH = TILE_SIZE * MAP_WIDTH * ZOOM_COEF;
 constexpr GLsizei WINDOW_HEIGHT = TILE_SIZE * MAP_HEIGHT * ZOOM_COEF;
-
-constexpr Pixel BG_COLOR{41, 60, 66, 255};
+constexpr double HEADLESS_FRAME_TIME = 1.0 / 60;
 
 void glfw_error_callback(int error, const char* description);
 void glfw_setup();
@@ -22,13 +32,22 @@ void OnMouseButtonClicked(GLFWwindow *window, int button, int action, int mods);
 void OnMouseMove(GLFWwindow *window, double xpos, double ypos);
 
 void ProcessMovement(Game &game);
-void GameUpdate(Game &game);
-void GameRender(Game &game);
+void GameUpdate(Game &game, double current_time);
+void GameRender(const FrameSnapshot &frame);
+void RunSimulation(Game &game, TripleBuffer<FrameSnapshot> &frames, const std::atomic<bool> &stop);
+int RunHeadless(int frames, const char *out_prefix);
+
+void GameEffects(const FrameSnapshot &frame);
 
-void GameEffects(const Game &game);
+// key presses and releases, from the GLFW callbacks to the simulation thread
+struct KeyEvent {
+    int key;
+    int action;
+};
+static SpscQueue<KeyEvent, 256> KeyEvents;
 
 struct InputState {
-    bool keys[1024] = {false};
+    bool keys[1024] = {false};  // held keys, owned by whichever thread runs GameUpdate
     GLfloat lastX = 400, lastY = 300;
     bool firstMouse = true;
     bool captureMouse = true;
@@ -36,25 +55,108 @@ struct InputState {
 } static Input;
 std::array<Image, 5> lightnings;
 
-int main() {
+// ./main                              -- play
+// ./main --headless [frames] [prefix]  -- render frames on the CPU without a window,
+//                                         optionally saving them as prefix00000.png, ...
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        return RunHeadless(argc > 2 ? std::stoi(argv[2]) : 600, argc > 3 ? argv[3] : nullptr);
+    }
     glfw_setup();
     GLFWwindow *window = setup_window();
     gl_setup();
     std::cout << glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MAJOR) << std::endl;
     print_game_info();
     Game game;
+    GlRenderer renderer;
+    bool batched = renderer.Init();
+    if (!batched) {
+        std::cerr << "No GL 3.3 shaders, drawing with glDrawPixels" << std::endl;
+    }
+    // the game runs on its own thread; this one only polls input and draws its snapshots
+    TripleBuffer<FrameSnapshot> frames;
+    game.Snapshot(frames.Back());
+    frames.Publish();
     glfwSetTime(0);
+    std::atomic<bool> stop{false};
+    std::thread simulation(RunSimulation, std::ref(game), std::ref(frames), std::cref(stop));
     while (!glfwWindowShouldClose(window)) {
-        GameRender(game);   
-        GameEffects(game);
+        frames.Acquire();
+        if (batched) {
+            renderer.Render(frames.Front());
+        } else {
+            GameRender(frames.Front());
+            GameEffects(frames.Front());
+        }
         glfwSwapBuffers(window);
         glfwPollEvents();
-        GameUpdate(game);
+    }
+    stop = true;
+    simulation.join();
+    if (batched && renderer.Stats().frames) {
+        const GlRenderStats &stats = renderer.Stats();
+        std::cout << "Per frame: " << stats.texture_bytes / stats.frames << " texture bytes, "
+                  << stats.vertex_bytes / stats.frames << " vertex bytes, "
+                  << static_cast<double>(stats.draw_calls) / stats.frames << " draw calls" << std::endl;
     }
     glfwTerminate();
     return 0;
 }
 
+// steps the game about once per Game::TICK, applying the queued key events first, and
+// publishes a snapshot after every step; a slow room change or vsync wait on the render
+// thread no longer delays input
+void RunSimulation(Game &game, TripleBuffer<FrameSnapshot> &frames, const std::atomic<bool> &stop) {
+    auto tick = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(Game::TICK));
+    auto next = std::chrono::steady_clock::now();
+    while (!stop) {
+        KeyEvent event;
+        while (KeyEvents.Pop(event)) {
+            if (event.action == GLFW_PRESS) {
+                Input.keys[event.key] = true;
+            } else if (event.action == GLFW_RELEASE) {
+                Input.keys[event.key] = false;
+            }
+        }
+        GameUpdate(game, glfwGetTime());
+        game.Snapshot(frames.Back());
+        frames.Publish();
+        next = std::max(next + tick, std::chrono::steady_clock::now());
+        std::this_thread::sleep_until(next);
+    }
+}
+
+int RunHeadless(int frames, const char *out_prefix) {
+    Game game;
+    ThreadPool pool;
+    SoftwareRenderer renderer(&pool);
+    FrameSnapshot snapshot;
+    Image zoomed;
+    std::chrono::duration<double, std::milli> render_time{};
+    int64_t touched_pixels = 0, frame_pixels = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+        game.Snapshot(snapshot);
+        renderer.Render(snapshot);
+        render_time += std::chrono::steady_clock::now() - start;
+        touched_pixels += renderer.Stats().touched_pixels;
+        frame_pixels += renderer.Stats().frame_pixels;
+        if (out_prefix) {
+            // saved at window size, as the player sees it
+            UpscaleNearest<ZOOM_COEF>(renderer.Frame(), zoomed);
+            std::string path = out_prefix;
+            char number[16];
+            std::snprintf(number, sizeof(number), "%05d.png", frame);
+            zoomed.Save((path + number).c_str());
+        }
+        GameUpdate(game, (frame + 1) * HEADLESS_FRAME_TIME);
+    }
+    std::cout << "Rendered " << frames << " frames headless: " << render_time.count() / frames
+              << " ms per frame, " << 100.0 * touched_pixels / frame_pixels
+              << "% of pixels recomposited" << std::endl;
+    return 0;
+}
+
 void glfw_error_callback(int error, const char* description) {
     std::cerr << "GLFW error with code " << error << " =(" << std::endl;
     std::cerr << description << std::endl;
@@ -125,10 +227,9 @@ void OnKeyboardPressed(GLFWwindow *window, int key, int scancode, int action, in
             glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
             break;
         default:
-            if (action == GLFW_PRESS)
-                Input.keys[key] = true;
-            else if (action == GLFW_RELEASE)
-                Input.keys[key] = false;
+            if (key >= 0 && key < 1024 && action != GLFW_REPEAT) {
+                KeyEvents.Push({key, action});
+            }
     }
 }
 
@@ -172,31 +273,37 @@ void ProcessMovement(Game &game) {
     }
 }
 
-void GameUpdate(Game &game) {
-    game.UpdTime(glfwGetTime());
-    if (game.State() == GameState::PLAY) {
-        game.MoveGuards();
-        ProcessMovement(game);
-        game.RoomChangeCheck();
+// runs as many fixed Game::TICKs as fit in the elapsed time; the remainder carries over
+// to the next frame and positions the sprites between ticks
+void GameUpdate(Game &game, double current_time) {
+    for (int ticks = game.UpdTime(current_time); ticks > 0; --ticks) {
+        game.BeginTick();
+        if (game.State() == GameState::PLAY) {
+            game.MoveGuards();
+            ProcessMovement(game);
+            game.RoomChangeCheck();
+        }
     }
 }
 
-void GameRender(Game &game) {
+void GameRender(const FrameSnapshot &frame) {
     glClear(GL_COLOR_BUFFER_BIT);
-    for (auto [pos, obj]: game.DrawList()) {
-        glWindowPos2i(ZOOM_COEF * pos.x, WINDOW_HEIGHT - ZOOM_COEF * pos.y);
-        if (obj.width() > TILE_SIZE * MAP_WIDTH) { // effect
+    for (const DrawCommand &cmd : frame.commands) {
+        const Image &obj = *cmd.image;
+        glWindowPos2i(ZOOM_COEF * cmd.pos.x, WINDOW_HEIGHT - ZOOM_COEF * cmd.pos.y);
+        if (cmd.mode == BlendMode::EFFECT) {
             glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
         } else {
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, obj.stride());
         glDrawPixels(obj.width(), obj.height(), GL_RGBA, GL_UNSIGNED_BYTE, obj.data());
         
     }
 }
 
-void GameEffects(const Game &game) {
-    GLfloat room_change_fade = std::min(static_cast<GLfloat>(game.RoomFade()), static_cast<GLfloat>(1));
+void GameEffects(const FrameSnapshot &frame) {
+    GLfloat room_change_fade = std::min(static_cast<GLfloat>(frame.fade), static_cast<GLfloat>(1));
     if (room_change_fade > 0) {
         glWindowPos2i(0, WINDOW_HEIGHT);
         glBlendColor(0, 0, 0, room_change_fade);
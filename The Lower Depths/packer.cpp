@@ -0,0 +1,93 @@
+// Build-time asset packer: decodes every PNG under map_design/{tiles,sprites,objects}
+// once and bakes them into a single pre-decoded RGBA bundle (see Bundle.h).
+// Tiles go into one atlas image instead of separate entries.
+// Also compiles every room's CSV + .mashgraph sources into a binary rooms/X.room (see Room.h).
+#include "Image.h"
+#include "Bundle.h"
+#include "Room.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <map_design dir> <output bundle>" << std::endl;
+        return 1;
+    }
+    fs::path root = argv[1];
+    std::vector<std::string> names{ATLAS_NAME};
+    for (const char *dir : {"sprites", "objects"}) {
+        for (const auto &file : fs::directory_iterator(root / dir)) {
+            if (file.path().extension() == ".png") {
+                names.push_back(std::string(dir) + "/" + file.path().stem().string());
+            }
+        }
+    }
+    std::sort(names.begin(), names.end());
+
+    std::vector<Image> images;
+    std::vector<BundleEntry> entries(names.size());
+    uint64_t offset = sizeof(BundleHeader) + entries.size() * sizeof(BundleEntry);
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i].size() >= BUNDLE_NAME_LEN) {
+            std::cerr << "Asset name too long: " << names[i] << std::endl;
+            return 1;
+        }
+        if (names[i] == ATLAS_NAME) {
+            images.push_back(BuildTileAtlas((root / "tiles").string() + "/"));
+        } else {
+            images.emplace_back((root / (names[i] + ".png")).string());
+        }
+        if (!images.back().data()) {
+            return 1;
+        }
+        offset = (offset + BUNDLE_ALIGN - 1) / BUNDLE_ALIGN * BUNDLE_ALIGN;
+        std::strncpy(entries[i].name, names[i].c_str(), BUNDLE_NAME_LEN);
+        entries[i].width = images.back().width();
+        entries[i].height = images.back().height();
+        entries[i].offset = offset;
+        offset += images.back().size();
+    }
+
+    std::ofstream fout(argv[2], std::ios::binary);
+    BundleHeader header{};
+    std::memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+    header.version = BUNDLE_VERSION;
+    header.count = entries.size();
+    fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(BundleEntry));
+    for (size_t i = 0; i < images.size(); ++i) {
+        static const char padding[BUNDLE_ALIGN]{};
+        fout.write(padding, entries[i].offset - fout.tellp());
+        fout.write(reinterpret_cast<const char *>(images[i].data()), images[i].size());
+    }
+    if (!fout) {
+        std::cerr << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cout << images.size() << " assets (" << offset << " bytes) packed to " << argv[2] << std::endl;
+
+    int rooms = 0;
+    for (const auto &file : fs::directory_iterator(root / "rooms")) {
+        std::string type = file.path().stem().string();
+        if (file.path().extension() != ".mashgraph" || type.size() != 1) {
+            continue;
+        }
+        RoomData room;
+        std::string rooms_dir = (root / "rooms").string() + "/";
+        if (!room.ParseText(rooms_dir, type[0]) || !room.Save(rooms_dir + type + ".room")) {
+            std::cerr << "Failed to compile room " << type << std::endl;
+            return 1;
+        }
+        ++rooms;
+    }
+    std::cout << rooms << " rooms compiled in " << (root / "rooms").string() << std::endl;
+    return 0;
+}
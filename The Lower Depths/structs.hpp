@@ -12,6 +12,15 @@ constexpr auto to_underlying(E e) noexcept {
 
 enum class Direction : int {UP, DOWN, LEFT, RIGHT};
 
+constexpr Direction Opposite(Direction dir) {
+    switch (dir) {
+        case Direction::UP: return Direction::DOWN;
+        case Direction::DOWN: return Direction::UP;
+        case Direction::LEFT: return Direction::RIGHT;
+        default: return Direction::LEFT;
+    }
+}
+
 template<class T>
 struct Point {
     T x;